@@ -0,0 +1,248 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <windows.h>
+#include "SDL2/include/SDL2/SDL.h"
+
+using namespace std;
+
+#pragma once
+
+// where the heap allocations of a frame come from. built with -DALLOC_TRACKING, telemetry.hpp's operator new
+// hands every allocation to alloc_tracker: it's counted (and its bytes) towards the phase of the frame the
+// host is in (input, update, render... set with phase()), and 1 in ALLOC_SAMPLE_EVERY has its call stack
+// taken and added up in a fixed table of stacks. writeReport (the game does it on exit) writes the
+// allocations and bytes per frame of each phase, then the stacks that allocated the most.
+//
+// nothing in here allocates while it's recording (the tables are fixed size, zero initialized before any
+// constructor runs), and allocations made while the tracker itself is busy aren't sampled. the stack table
+// is shared between threads behind a spin lock, everything else is relaxed atomics. addresses are written
+// as module+offset: addr2line -f -C -e main.exe <image base + offset> (0x140000000 for 64 bit mingw builds,
+// 0x400000 for 32 bit ones, built with -g) turns them into functions and lines.
+
+#ifdef ALLOC_TRACKING
+const bool ALLOC_TRACKING_ENABLED = true;
+#else
+const bool ALLOC_TRACKING_ENABLED = false;
+#endif
+
+const int ALLOC_PHASES = 8;
+const int ALLOC_SAMPLE_EVERY = 16;
+const int ALLOC_STACK_DEPTH = 14;
+const int ALLOC_STACK_SLOTS = 2048; // power of 2
+const int ALLOC_REPORT_STACKS = 20;
+
+struct AllocStack{
+    Uint32 hash; // 0 = free slot
+    int phase;
+    int depth;
+    void *frames[ALLOC_STACK_DEPTH];
+    Uint64 samples;
+    Uint64 bytes;
+};
+
+struct AllocPhase{
+    const char *name;
+    atomic<Uint64> allocations;
+    atomic<Uint64> bytes;
+    Uint64 frame_allocations_before; // at the end of the last frame
+    Uint64 max_frame_allocations;
+};
+
+class AllocTracker{
+    public:
+        // phase 0 is whatever happens before the first phase() call
+        AllocPhase phases[ALLOC_PHASES];
+        int phase_count;
+        atomic<int> current;
+
+        atomic<Uint64> allocations;
+        atomic<Uint64> frees;
+        Uint64 frames;
+
+        AllocStack stacks[ALLOC_STACK_SLOTS];
+        Uint64 dropped_samples; // table full
+
+        // methods
+        void allocated(size_t size);
+        void freed();
+        void phase(const char *name);
+        void endFrame();
+        bool writeReport(string path);
+
+        void sample(int phase_index, size_t size);
+};
+
+AllocTracker alloc_tracker;
+
+// guards alloc_tracker.stacks. out here rather than a member so ATOMIC_FLAG_INIT can start it clear without
+// giving AllocTracker a constructor (which would run after other static constructors had allocated)
+atomic_flag alloc_tracker_stacks_lock = ATOMIC_FLAG_INIT;
+
+// set while this thread is inside the tracker, its own allocations (and recursion) aren't sampled
+thread_local bool alloc_tracker_busy = false;
+
+void AllocTracker::allocated(size_t size){
+    int phase_index = current.load(memory_order_relaxed);
+    phases[phase_index].allocations.fetch_add(1, memory_order_relaxed);
+    phases[phase_index].bytes.fetch_add(size, memory_order_relaxed);
+    Uint64 number = allocations.fetch_add(1, memory_order_relaxed);
+    if (number % ALLOC_SAMPLE_EVERY == 0 && !alloc_tracker_busy){
+        sample(phase_index, size);
+    }
+}
+
+void AllocTracker::freed(){
+    frees.fetch_add(1, memory_order_relaxed);
+}
+
+void AllocTracker::sample(int phase_index, size_t size){
+    alloc_tracker_busy = true;
+
+    // the first frame or two left are allocated / operator new (depending on what got inlined)
+    void *frames[ALLOC_STACK_DEPTH];
+    int depth = CaptureStackBackTrace(1, ALLOC_STACK_DEPTH, frames, NULL);
+    Uint32 hash = 2166136261u ^ phase_index;
+    for (int i = 0; i != depth; i++){
+        hash = (hash ^ Uint32(size_t(frames[i]) >> 2)) * 16777619u;
+    }
+    hash |= 1;
+
+    while (alloc_tracker_stacks_lock.test_and_set(memory_order_acquire)){}
+    Uint32 slot = hash & (ALLOC_STACK_SLOTS - 1);
+    for (int probe = 0; probe != ALLOC_STACK_SLOTS; probe++){
+        AllocStack &stack = stacks[slot];
+        if (stack.hash == 0){
+            stack.hash = hash;
+            stack.phase = phase_index;
+            stack.depth = depth;
+            memcpy(stack.frames, frames, sizeof(void*) * depth);
+        }
+        if (stack.hash == hash && stack.phase == phase_index && stack.depth == depth && memcmp(stack.frames, frames, sizeof(void*) * depth) == 0){
+            stack.samples += 1;
+            stack.bytes += size;
+            break;
+        }
+        slot = (slot + 1) & (ALLOC_STACK_SLOTS - 1);
+        if (probe + 1 == ALLOC_STACK_SLOTS){
+            dropped_samples += 1;
+        }
+    }
+    alloc_tracker_stacks_lock.clear(memory_order_release);
+
+    alloc_tracker_busy = false;
+}
+
+void AllocTracker::phase(const char *name){
+    // names are compared as strings, so literals are fine. past ALLOC_PHASES phases the last one gets the rest
+    for (int i = 1; i < phase_count; i++){
+        if (strcmp(phases[i].name, name) == 0){
+            current.store(i, memory_order_relaxed);
+            return;
+        }
+    }
+    if (phase_count == 0){
+        phases[0].name = "startup";
+        phase_count = 1;
+    }
+    if (phase_count == ALLOC_PHASES){
+        current.store(ALLOC_PHASES - 1, memory_order_relaxed);
+        return;
+    }
+    phases[phase_count].name = name;
+    current.store(phase_count, memory_order_relaxed);
+    phase_count += 1;
+}
+
+void AllocTracker::endFrame(){
+    // worst frame of each phase
+    for (int i = 0; i != phase_count; i++){
+        Uint64 total = phases[i].allocations.load(memory_order_relaxed);
+        phases[i].max_frame_allocations = max(phases[i].max_frame_allocations, total - phases[i].frame_allocations_before);
+        phases[i].frame_allocations_before = total;
+    }
+    frames += 1;
+}
+
+string allocAddressText(void *address){
+    // module file name (without the directory) + offset into it
+    HMODULE module = NULL;
+    char path[MAX_PATH] = "?";
+    if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCSTR)address, &module)){
+        GetModuleFileNameA(module, path, MAX_PATH);
+    }
+    const char *name = path;
+    for (const char *c = path; *c; c++){
+        if (*c == '\\' || *c == '/'){
+            name = c + 1;
+        }
+    }
+    char text[MAX_PATH + 32];
+    snprintf(text, sizeof(text), "%s+0x%llx", name, (unsigned long long)(size_t(address) - size_t(module)));
+    return text;
+}
+
+bool AllocTracker::writeReport(string path){
+    alloc_tracker_busy = true;
+
+    ofstream file(path);
+    if (!file){
+        cout << "Couldn't write allocation report " << path << "\n";
+        alloc_tracker_busy = false;
+        return false;
+    }
+
+    Uint64 frame_count = max(frames, Uint64(1));
+    Uint64 total_allocations = allocations.load(memory_order_relaxed);
+    file << "allocations " << total_allocations << ", frees " << frees.load(memory_order_relaxed) << ", frames " << frames << "\n\n";
+
+    // phases, the startup one isn't per frame
+    char line[256];
+    snprintf(line, sizeof(line), "%-12s %14s %14s %14s\n", "phase", "allocs/frame", "bytes/frame", "max allocs");
+    file << line;
+    for (int i = 0; i != phase_count; i++){
+        Uint64 phase_allocations = phases[i].allocations.load(memory_order_relaxed);
+        Uint64 phase_bytes = phases[i].bytes.load(memory_order_relaxed);
+        if (i == 0){
+            snprintf(line, sizeof(line), "%-12s %14llu %14llu (in total)\n", phases[i].name, (unsigned long long)phase_allocations, (unsigned long long)phase_bytes);
+        } else {
+            snprintf(line, sizeof(line), "%-12s %14.1f %14.1f %14llu\n", phases[i].name, double(phase_allocations) / frame_count, double(phase_bytes) / frame_count, (unsigned long long)phases[i].max_frame_allocations);
+        }
+        file << line;
+    }
+
+    // hotspots, most sampled first (samples are 1 in ALLOC_SAMPLE_EVERY, so scaled back up)
+    while (alloc_tracker_stacks_lock.test_and_set(memory_order_acquire)){}
+    vector<AllocStack*> sorted;
+    Uint64 total_samples = 0;
+    for (AllocStack &stack : stacks){
+        if (stack.hash != 0){
+            sorted.push_back(&stack);
+            total_samples += stack.samples;
+        }
+    }
+    sort(sorted.begin(), sorted.end(), [](AllocStack *a, AllocStack *b){ return a -> samples > b -> samples; });
+
+    file << "\nhotspots (1 in " << ALLOC_SAMPLE_EVERY << " allocations sampled, " << sorted.size() << " different stacks";
+    if (dropped_samples){
+        file << ", " << dropped_samples << " samples didn't fit";
+    }
+    file << ")\n";
+    for (int i = 0; i != min(int(sorted.size()), ALLOC_REPORT_STACKS); i++){
+        AllocStack &stack = *sorted[i];
+        snprintf(line, sizeof(line), "\n#%d %s: %.1f%%, ~%.1f allocs/frame, ~%.0f bytes/frame\n", i + 1, phases[stack.phase].name, stack.samples * 100.0 / max(total_samples, Uint64(1)), double(stack.samples) * ALLOC_SAMPLE_EVERY / frame_count, double(stack.bytes) * ALLOC_SAMPLE_EVERY / frame_count);
+        file << line;
+        for (int frame = 0; frame != stack.depth; frame++){
+            file << "    " << allocAddressText(stack.frames[frame]) << "\n";
+        }
+    }
+    alloc_tracker_stacks_lock.clear(memory_order_release);
+
+    alloc_tracker_busy = false;
+    return true;
+}
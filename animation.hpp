@@ -0,0 +1,85 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "SDL2/include/SDL2/SDL.h"
+
+using namespace std;
+
+#pragma once
+
+// animation clips are loaded once and shared. objects only keep which clip they play and the
+// tick it started on, the current frame is worked out from the game tick when drawing.
+
+const int ANIMATION_LOOP = 0;
+const int ANIMATION_ONCE = 1;
+
+struct AnimationClip{
+    vector<SDL_Texture*> frames;
+    int frame_ticks;
+    int loop_mode;
+};
+
+struct Animation{
+    Uint32 clip = 0; // clip ids fit in 16 bits, 32 so the struct has no padding
+    Uint32 start_tick = 0;
+};
+
+class AnimationClips{
+    public:
+        vector<AnimationClip> clips;
+        unordered_map<string, Uint16> clip_ids;
+
+        // methods
+        Uint16 add(string name, vector<SDL_Texture*> frames, int frame_ticks, int loop_mode);
+        Uint16 id(string name);
+        Animation start(Uint16 clip, long long tick);
+        int frameIndex(Animation animation, long long tick);
+        SDL_Texture* frame(Animation animation, long long tick);
+        bool finished(Animation animation, long long tick);
+};
+
+Uint16 AnimationClips::add(string name, vector<SDL_Texture*> frames, int frame_ticks, int loop_mode = ANIMATION_LOOP){
+    // replace if the name is already used, so clips can be reloaded
+    AnimationClip clip = {frames, max(frame_ticks, 1), loop_mode};
+    if (clip_ids.find(name) != clip_ids.end()){
+        clips[clip_ids[name]] = clip;
+        return clip_ids[name];
+    }
+
+    clips.push_back(clip);
+    clip_ids[name] = clips.size() - 1;
+    return clip_ids[name];
+}
+
+Uint16 AnimationClips::id(string name){
+    if (clip_ids.find(name) == clip_ids.end()){
+        cout << "Unknown animation clip: " << name << "\n";
+        return 0;
+    }
+    return clip_ids[name];
+}
+
+Animation AnimationClips::start(Uint16 clip, long long tick){
+    return {clip, Uint32(tick)};
+}
+
+int AnimationClips::frameIndex(Animation animation, long long tick){
+    AnimationClip &clip = clips[animation.clip];
+    int frame = (Uint32(tick) - animation.start_tick) / clip.frame_ticks;
+
+    // loop or stay on the last frame
+    if (clip.loop_mode == ANIMATION_LOOP){
+        return frame % clip.frames.size();
+    }
+    return min(frame, int(clip.frames.size()) - 1);
+}
+
+SDL_Texture* AnimationClips::frame(Animation animation, long long tick){
+    return clips[animation.clip].frames[frameIndex(animation, tick)];
+}
+
+bool AnimationClips::finished(Animation animation, long long tick){
+    AnimationClip &clip = clips[animation.clip];
+    return clip.loop_mode == ANIMATION_ONCE && (Uint32(tick) - animation.start_tick) >= clip.frame_ticks * clip.frames.size();
+}
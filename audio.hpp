@@ -1,66 +1,399 @@
 #include <iostream>
+#include <vector>
 #include <unordered_map>
+#include <string>
+#include <atomic>
+#include <cmath>
 #include <algorithm>
+#include <immintrin.h>
 #include "SDL2/include/SDL2/SDL.h"
 #include "SDL2/include/SDL2/SDL_image.h"
-#include "SDL2/include/SDL2/SDL_mixer.h"
 
 using namespace std;
 
 #pragma once
 
-unordered_map<string, Mix_Chunk*> cached_chunks;
-unordered_map<string, Mix_Music*> cached_music;
-unordered_map<string, int> alloc_channels; // different channel for each chunk
+// sounds a world plays go through one of these. MixerAudio mixes everything itself in the audio device's
+// callback (one per process, it owns the device), SilentAudio plays nothing (headless worlds).
+// plays are counted until whoever reads them (telemetry) resets them.
 
-Mix_Chunk* loadChunkWav(string path){
-    Mix_Chunk* returned_audio = Mix_LoadWAV(path.c_str());
-    if (returned_audio == NULL){
-        cout << "Error loading audio: " << Mix_GetError() << "\n";
+class AudioBackend{
+    public:
+        int play_calls = 0;
+
+        virtual ~AudioBackend(){}
+
+        virtual void playChunkWav(string path, float volume = 1, float pan = 0) = 0; // pan -1 (left) to 1 (right)
+        virtual void playMusicWav(string path, int loops) = 0;
+        virtual void fadeOutMusic(int ms) = 0;
+        virtual int activeVoices() = 0;
+        virtual int underruns() = 0;
+};
+
+// every play is its own voice, up to max_voices at once (past that the voice closest to finishing is
+// dropped, music never is). voices are added up with sse (avx2 where the cpu has it), gains ramp over a
+// buffer instead of jumping so volume changes and fades don't click, and the sum is soft clipped so a
+// pile of explosions gets louder without wrapping around.
+//
+// sounds are converted once when first played to interleaved stereo floats at the device rate, with
+// MIXER_PADDING zeroes after them so the simd loops never need a tail. the game thread only touches voices
+// with the device locked, which SDL also holds around the callback.
+//
+// an underrun is counted whenever a callback comes half a buffer or more late: the device had nothing left to
+// play (or close to it) by then.
+
+const int MIXER_RATE = 44100;
+const int MIXER_PADDING = 8; // floats
+const float MIXER_CLIP_KNEE = 0.6f; // soft clipping starts here
+
+struct MixerSound{
+    vector<float> samples; // left, right, left, right...
+    int frames = 0;
+};
+
+struct MixerVoice{
+    MixerSound *sound;
+    int position = 0; // frames
+    int loops = 0; // extra times to play after this one, -1 forever
+    bool music = false;
+
+    float volume = 1;
+    float pan = 0;
+    float fade_per_frame = 0; // taken off volume every frame, voice stops at 0
+
+    // gains at the start of the next buffer (ramped to volume / pan over it), sounds start at full
+    float left = 0;
+    float right = 0;
+};
+
+void mixVoiceSSE(float *out, const float *in, int frames, float left, float right, float left_step, float right_step){
+    // 2 frames at a time
+    __m128 gain = _mm_setr_ps(left, right, left + left_step, right + right_step);
+    __m128 step = _mm_setr_ps(left_step * 2, right_step * 2, left_step * 2, right_step * 2);
+    for (int i = 0; i < frames * 2; i += 4){
+        __m128 mixed = _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(in + i), gain));
+        _mm_storeu_ps(out + i, mixed);
+        gain = _mm_add_ps(gain, step);
+    }
+}
+
+__attribute__((target("avx2")))
+void mixVoiceAVX2(float *out, const float *in, int frames, float left, float right, float left_step, float right_step){
+    // 4 frames at a time
+    __m256 gain = _mm256_setr_ps(left, right, left + left_step, right + right_step, left + left_step * 2, right + right_step * 2, left + left_step * 3, right + right_step * 3);
+    __m256 step = _mm256_setr_ps(left_step * 4, right_step * 4, left_step * 4, right_step * 4, left_step * 4, right_step * 4, left_step * 4, right_step * 4);
+    for (int i = 0; i < frames * 2; i += 8){
+        __m256 mixed = _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_mul_ps(_mm256_loadu_ps(in + i), gain));
+        _mm256_storeu_ps(out + i, mixed);
+        gain = _mm256_add_ps(gain, step);
+    }
+}
+
+void panGains(float volume, float pan, float &left, float &right){
+    // equal power, 1 in the middle
+    float angle = (pan + 1) * float(M_PI) / 4;
+    left = volume * cos(angle) * float(M_SQRT2);
+    right = volume * sin(angle) * float(M_SQRT2);
+}
+
+float softClip(float x){
+    // straight below the knee, then bends over towards 1 (same slope at the knee)
+    float magnitude = fabs(x);
+    float over = max(magnitude - MIXER_CLIP_KNEE, 0.0f) / (1 - MIXER_CLIP_KNEE);
+    magnitude = min(magnitude, MIXER_CLIP_KNEE + (1 - MIXER_CLIP_KNEE) * over / (1 + over));
+    return copysign(magnitude, x);
+}
+
+void softClipSSE(float *out, const float *in, int count, float volume){
+    // softClip on 4 samples at a time
+    __m128 scale = _mm_set1_ps(volume);
+    __m128 sign_bit = _mm_set1_ps(-0.0f);
+    __m128 knee = _mm_set1_ps(MIXER_CLIP_KNEE);
+    __m128 range = _mm_set1_ps(1 - MIXER_CLIP_KNEE);
+    __m128 one = _mm_set1_ps(1);
+    __m128 zero = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 4 <= count; i += 4){
+        __m128 x = _mm_mul_ps(_mm_loadu_ps(in + i), scale);
+        __m128 sign = _mm_and_ps(x, sign_bit);
+        __m128 magnitude = _mm_andnot_ps(sign_bit, x);
+        __m128 over = _mm_div_ps(_mm_max_ps(_mm_sub_ps(magnitude, knee), zero), range);
+        __m128 bent = _mm_add_ps(knee, _mm_mul_ps(range, _mm_div_ps(over, _mm_add_ps(one, over))));
+        _mm_storeu_ps(out + i, _mm_or_ps(_mm_min_ps(magnitude, bent), sign));
+    }
+    for (; i < count; i++){
+        out[i] = softClip(in[i] * volume);
     }
-    return returned_audio;
 }
 
-void playChunkWav(string path){
+class MixerAudio : public AudioBackend{
+    public:
+        SDL_AudioDeviceID device = 0;
+        int buffer_frames;
+        int max_voices;
+        float master_volume;
+        bool avx2;
 
-    Mix_Chunk* played_chunk;
-    
-    // check if chunk is cached
-    if (cached_chunks.find(path) != cached_chunks.end()){
+        unordered_map<string, MixerSound*> cached_sounds; // chunks and music
+        vector<MixerVoice> voices; // device locked
+        vector<float> mix_buffer;
 
-        played_chunk = cached_chunks[path];
+        // audio thread
+        Uint64 buffer_period;
+        Uint64 last_callback = 0;
+        atomic<int> voice_count;
+        atomic<int> underrun_count;
 
-    } else { // load and cache the chunk
+        // methods
+        MixerAudio(int buffer_frames_, int max_voices_, float master_volume_);
+        ~MixerAudio();
+        void playChunkWav(string path, float volume, float pan);
+        void playMusicWav(string path, int loops);
+        void fadeOutMusic(int ms);
+        int activeVoices();
+        int underruns();
 
-        played_chunk = loadChunkWav(path);
-        cached_chunks[path] = played_chunk;
-        alloc_channels[path] = alloc_channels.size();
+        MixerSound* loadSound(string path);
+        void play(MixerVoice &voice);
+        void mix(float *out, int frames);
+        static void callback(void *userdata, Uint8 *stream, int len);
 
+        MixerAudio(const MixerAudio&) = delete;
+        MixerAudio& operator=(const MixerAudio&) = delete;
+};
+
+MixerAudio::MixerAudio(int buffer_frames_, int max_voices_, float master_volume_ = 0.8f) : voice_count(0), underrun_count(0){
+    buffer_frames = buffer_frames_;
+    max_voices = max(max_voices_, 1);
+    master_volume = master_volume_;
+    avx2 = SDL_HasAVX2();
+    voices.reserve(max_voices);
+
+    SDL_AudioSpec desired = {};
+    desired.freq = MIXER_RATE;
+    desired.format = AUDIO_F32SYS;
+    desired.channels = 2;
+    desired.samples = buffer_frames;
+    desired.callback = callback;
+    desired.userdata = this;
+
+    // SDL converts if the device wants something else
+    SDL_AudioSpec obtained;
+    device = SDL_OpenAudioDevice(NULL, 0, &desired, &obtained, 0);
+    if (device == 0){
+        cout << "Couldn't open audio device: " << SDL_GetError() << "\n";
+        return;
     }
+    buffer_frames = obtained.samples;
+    buffer_period = SDL_GetPerformanceFrequency() * buffer_frames / MIXER_RATE;
+    mix_buffer.resize(buffer_frames * 2 + MIXER_PADDING);
+    SDL_PauseAudioDevice(device, 0);
+}
 
-    Mix_PlayChannel(alloc_channels[path], played_chunk, 0);
+MixerAudio::~MixerAudio(){
+    if (device != 0){
+        SDL_CloseAudioDevice(device);
+    }
+    for (auto &cached : cached_sounds){
+        delete cached.second;
+    }
 }
 
-void playMusicWav(string path, int loops){
+MixerSound* MixerAudio::loadSound(string path){
+    // check if the sound is cached
+    if (cached_sounds.find(path) != cached_sounds.end()){
+        return cached_sounds[path];
+    }
+
+    // load and cache it (NULL if it didn't load, so it isn't tried again)
+    MixerSound *sound = NULL;
+    SDL_AudioSpec spec;
+    Uint8 *buffer;
+    Uint32 length;
+    if (SDL_LoadWAV(path.c_str(), &spec, &buffer, &length) == NULL){
+        cout << "Error loading audio: " << SDL_GetError() << "\n";
+    } else {
+        SDL_AudioStream *stream = SDL_NewAudioStream(spec.format, spec.channels, spec.freq, AUDIO_F32SYS, 2, MIXER_RATE);
+        if (stream == NULL || SDL_AudioStreamPut(stream, buffer, length) != 0 || SDL_AudioStreamFlush(stream) != 0){
+            cout << "Error converting audio " << path << ": " << SDL_GetError() << "\n";
+        } else {
+            sound = new MixerSound;
+            int bytes = SDL_AudioStreamAvailable(stream);
+            sound -> frames = bytes / (2 * sizeof(float));
+            sound -> samples.resize(sound -> frames * 2 + MIXER_PADDING, 0);
+            SDL_AudioStreamGet(stream, sound -> samples.data(), sound -> frames * 2 * sizeof(float));
+        }
+        if (stream != NULL){
+            SDL_FreeAudioStream(stream);
+        }
+        SDL_FreeWAV(buffer);
+    }
+    cached_sounds[path] = sound;
+    return sound;
+}
 
-    Mix_Music* played_music;
+void MixerAudio::play(MixerVoice &voice){
+    panGains(voice.volume, voice.pan, voice.left, voice.right);
 
-    // check if music is cached
-    if (cached_music.find(path) != cached_music.end()){
+    SDL_LockAudioDevice(device);
 
-        played_music = cached_music[path];
+    // full: replace whichever sound effect has the least left to play
+    if (int(voices.size()) >= max_voices){
+        int replaced = -1;
+        int least_left = 0;
+        for (size_t i = 0; i != voices.size(); i++){
+            int left = voices[i].sound -> frames - voices[i].position;
+            if (!voices[i].music && (replaced == -1 || left < least_left)){
+                replaced = i;
+                least_left = left;
+            }
+        }
+        if (replaced != -1){
+            voices[replaced] = voice;
+        }
+    } else {
+        voices.push_back(voice);
+    }
 
-    } else { // load and cache the music
+    SDL_UnlockAudioDevice(device);
+}
 
-        played_music = Mix_LoadMUS(path.c_str());
-        cached_music[path] = played_music;
+void MixerAudio::playChunkWav(string path, float volume, float pan){
 
+    play_calls += 1;
+
+    MixerSound *sound = loadSound(path);
+    if (device == 0 || sound == NULL){
+        return;
+    }
+
+    MixerVoice voice;
+    voice.sound = sound;
+    voice.volume = volume;
+    voice.pan = clamp(pan, -1.0f, 1.0f);
+    play(voice);
+}
+
+void MixerAudio::playMusicWav(string path, int loops){
+
+    play_calls += 1;
+
+    MixerSound *sound = loadSound(path);
+    if (device == 0 || sound == NULL){
+        return;
     }
 
-    if (Mix_PlayingMusic()){
-        Mix_FadeOutMusic(1000);
+    // whatever was playing fades out under the new music
+    fadeOutMusic(1000);
+
+    MixerVoice voice;
+    voice.sound = sound;
+    voice.loops = loops;
+    voice.music = true;
+    play(voice);
+}
+
+void MixerAudio::fadeOutMusic(int ms){
+    if (device == 0){
+        return;
     }
+    SDL_LockAudioDevice(device);
+    for (MixerVoice &voice : voices){
+        if (voice.music && voice.fade_per_frame == 0){
+            voice.fade_per_frame = voice.volume / max(ms * MIXER_RATE / 1000, 1);
+        }
+    }
+    SDL_UnlockAudioDevice(device);
+}
+
+int MixerAudio::activeVoices(){
+    return voice_count.load(memory_order_relaxed);
+}
+
+int MixerAudio::underruns(){
+    return underrun_count.load(memory_order_relaxed);
+}
 
-    Mix_PlayMusic(played_music, loops);
+void MixerAudio::mix(float *out, int frames){
+    // out holds frames * 2 + MIXER_PADDING floats
+    fill(out, out + frames * 2 + MIXER_PADDING, 0.0f);
+
+    for (size_t i = 0; i != voices.size();){
+        MixerVoice &voice = voices[i];
+
+        // gains to ramp to by the end of this buffer
+        float volume = max(voice.volume - voice.fade_per_frame * frames, 0.0f);
+        float left, right;
+        panGains(volume, voice.pan, left, right);
+        float left_step = (left - voice.left) / frames;
+        float right_step = (right - voice.right) / frames;
+
+        // a stretch up to the end of the sound or the buffer, then start over if it loops
+        int done = 0;
+        bool finished = false;
+        while (done != frames && !finished){
+            int count = min(frames - done, voice.sound -> frames - voice.position);
+            float gain_left = voice.left + left_step * done;
+            float gain_right = voice.right + right_step * done;
+            const float *in = voice.sound -> samples.data() + voice.position * 2;
+            if (avx2){
+                mixVoiceAVX2(out + done * 2, in, count, gain_left, gain_right, left_step, right_step);
+            } else {
+                mixVoiceSSE(out + done * 2, in, count, gain_left, gain_right, left_step, right_step);
+            }
+
+            done += count;
+            voice.position += count;
+            if (voice.position == voice.sound -> frames){
+                if (voice.loops == 0){
+                    finished = true;
+                } else {
+                    voice.loops -= (voice.loops > 0);
+                    voice.position = 0;
+                }
+            }
+        }
+
+        voice.volume = volume;
+        voice.left = left;
+        voice.right = right;
+
+        if (finished || (voice.fade_per_frame > 0 && volume == 0)){
+            voices[i] = voices.back();
+            voices.pop_back();
+        } else {
+            i++;
+        }
+    }
+}
+
+void MixerAudio::callback(void *userdata, Uint8 *stream, int len){
+    MixerAudio &audio = *(MixerAudio*)userdata;
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (audio.last_callback != 0 && now - audio.last_callback > audio.buffer_period * 3 / 2){
+        audio.underrun_count.fetch_add(1, memory_order_relaxed);
+    }
+    audio.last_callback = now;
+
+    float *out = (float*)stream;
+    int frames = len / (2 * sizeof(float));
+    while (frames > 0){
+        int mixed = min(frames, audio.buffer_frames);
+        audio.mix(audio.mix_buffer.data(), mixed);
+        softClipSSE(out, audio.mix_buffer.data(), mixed * 2, audio.master_volume);
+        out += mixed * 2;
+        frames -= mixed;
+    }
+
+    audio.voice_count.store(audio.voices.size(), memory_order_relaxed);
+}
 
-}
\ No newline at end of file
+class SilentAudio : public AudioBackend{
+    public:
+        void playChunkWav(string path, float volume, float pan){}
+        void playMusicWav(string path, int loops){}
+        void fadeOutMusic(int ms){}
+        int activeVoices(){ return 0; }
+        int underruns(){ return 0; }
+};
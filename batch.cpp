@@ -0,0 +1,337 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "render-backend.hpp"
+#include "audio.hpp"
+#include "config.hpp"
+#include "world.hpp"
+#include "save-state.hpp"
+#include "bot.hpp"
+
+using namespace std;
+
+// runs lots of headless games on every core and writes what happened to csv / json.
+//
+// batch --games 1000 --seed 1 --bot random --csv games.csv --json games.json
+//     --games N      games to run (default 100)
+//     --seed S       first seed, game i uses S + i (default 1)
+//     --threads T    worker threads (default every core)
+//     --ticks T      give up on a game after this many ticks (default 30 minutes)
+//     --bot B        random (random walk) or chase (stays under the nearest enemy)
+//     --config PATH  enemy / wave config (default config/game.cfg)
+//     --state PATH   start every game from this save state (random generator reseeded per game)
+//     --csv PATH     one row per game
+//     --json PATH    every game plus peaks for every wave
+//     --check-saves T  save every game T ticks in, load it into a second world and play both on: any
+//                      tick their save states differ counts as a failed game (and batch exits with 1)
+
+const int TICKS_PER_SECOND = 120;
+
+struct WaveStats{
+    int games = 0; // games that reached this wave
+    int peak_bullets = 0;
+    int peak_entities = 0;
+    int peak_enemies = 0;
+    float max_tick_us = 0;
+};
+
+struct GameStats{
+    unsigned int seed;
+    bool died = false;
+    int wave = 1;
+    long long ticks = 0; // ticks spent playing
+    int peak_bullets = 0;
+    int peak_entities = 0;
+    float mean_tick_us = 0;
+    float p99_tick_us = 0;
+    float max_tick_us = 0;
+    vector<WaveStats> waves;
+    long long save_diverged_after = -1; // --check-saves: ticks after loading the copy first differed
+};
+
+GameStats runGame(unsigned int seed, string bot_kind, long long max_ticks, ConfigSections config, vector<Uint8> &state, long long check_saves_tick){
+    NullRender render;
+    SilentAudio audio;
+    World world(render, audio, seed, 1000.0f / TICKS_PER_SECOND);
+    world.applyConfig(config);
+    if (!state.empty() && loadWorld(world, state.data(), state.size())){
+        world.rand_generator.seed(seed);
+    }
+    Bot bot(bot_kind, seed);
+
+    GameStats stats;
+    stats.seed = seed;
+    vector<float> tick_times;
+    tick_times.reserve(min(max_ticks, 1LL << 20));
+    bool started = false;
+
+    // --check-saves: a copy loaded from a save of this world, played alongside it by a copy of the bot
+    unique_ptr<World> loaded;
+    Bot loaded_bot = bot;
+    vector<Uint8> save, loaded_save;
+    long long world_ticks = 0;
+
+    while (world.running && stats.ticks < max_ticks){
+        WorldInput input;
+        bot.input(world, input);
+
+        auto start = chrono::steady_clock::now();
+        world.update(input);
+        float tick_us = chrono::duration<float, micro>(chrono::steady_clock::now() - start).count();
+        world_ticks += 1;
+
+        if (world_ticks == check_saves_tick){
+            saveWorld(world, save);
+            loaded.reset(new World(render, audio, seed + 1, 1000.0f / TICKS_PER_SECOND));
+            loaded -> applyConfig(config);
+            if (!loadWorld(*loaded, save.data(), save.size())){
+                stats.save_diverged_after = 0;
+                loaded.reset();
+            }
+            loaded_bot = bot;
+        } else if (loaded){
+            WorldInput loaded_input;
+            loaded_bot.input(*loaded, loaded_input);
+            loaded -> update(loaded_input);
+            saveWorld(world, save);
+            saveWorld(*loaded, loaded_save);
+            if (save != loaded_save){
+                stats.save_diverged_after = world_ticks - check_saves_tick;
+                loaded.reset();
+            }
+        }
+
+        // game over once it leaves the playing state
+        if (world.game_state == PLAYING){
+            started = true;
+        } else if (started){
+            stats.died = true;
+            break;
+        } else {
+            continue;
+        }
+
+        stats.ticks += 1;
+        stats.wave = world.wave;
+        tick_times.push_back(tick_us);
+
+        // peaks, overall and for the current wave
+        int bullets = world.entities.count<EnemyShot>();
+        int entity_count = world.entities.entity_count;
+        int enemies = world.entities.count<EnemyInfo>();
+        stats.peak_bullets = max(stats.peak_bullets, bullets);
+        stats.peak_entities = max(stats.peak_entities, entity_count);
+
+        if (int(stats.waves.size()) < world.wave){
+            stats.waves.resize(world.wave);
+            stats.waves[world.wave - 1].games = 1;
+        }
+        WaveStats &wave_stats = stats.waves[world.wave - 1];
+        wave_stats.peak_bullets = max(wave_stats.peak_bullets, bullets);
+        wave_stats.peak_entities = max(wave_stats.peak_entities, entity_count);
+        wave_stats.peak_enemies = max(wave_stats.peak_enemies, enemies);
+        wave_stats.max_tick_us = max(wave_stats.max_tick_us, tick_us);
+    }
+
+    // tick cost
+    if (!tick_times.empty()){
+        double total = 0;
+        for (float tick_us: tick_times){
+            total += tick_us;
+        }
+        stats.mean_tick_us = total / tick_times.size();
+        stats.max_tick_us = *max_element(tick_times.begin(), tick_times.end());
+        size_t p99 = tick_times.size() * 99 / 100;
+        nth_element(tick_times.begin(), tick_times.begin() + p99, tick_times.end());
+        stats.p99_tick_us = tick_times[p99];
+    }
+    return stats;
+}
+
+void writeCsv(string path, vector<GameStats> &games){
+    ofstream file(path);
+    if (!file){
+        cout << "Couldn't write " << path << "\n";
+        return;
+    }
+    file << "seed,died,wave,ticks,seconds,peak_bullets,peak_entities,mean_tick_us,p99_tick_us,max_tick_us\n";
+    for (GameStats &game: games){
+        file << game.seed << "," << game.died << "," << game.wave << "," << game.ticks << "," << float(game.ticks) / TICKS_PER_SECOND << ","
+             << game.peak_bullets << "," << game.peak_entities << "," << game.mean_tick_us << "," << game.p99_tick_us << "," << game.max_tick_us << "\n";
+    }
+}
+
+void writeJson(string path, vector<GameStats> &games, vector<WaveStats> &waves, string bot_kind){
+    ofstream file(path);
+    if (!file){
+        cout << "Couldn't write " << path << "\n";
+        return;
+    }
+    file << "{\n  \"bot\": \"" << bot_kind << "\",\n  \"ticks_per_second\": " << TICKS_PER_SECOND << ",\n  \"waves\": [\n";
+    for (int i = 0; i != int(waves.size()); i++){
+        WaveStats &wave = waves[i];
+        file << "    {\"wave\": " << i + 1 << ", \"games\": " << wave.games << ", \"peak_bullets\": " << wave.peak_bullets
+             << ", \"peak_entities\": " << wave.peak_entities << ", \"peak_enemies\": " << wave.peak_enemies
+             << ", \"max_tick_us\": " << wave.max_tick_us << "}" << (i + 1 != int(waves.size()) ? "," : "") << "\n";
+    }
+    file << "  ],\n  \"games\": [\n";
+    for (int i = 0; i != int(games.size()); i++){
+        GameStats &game = games[i];
+        file << "    {\"seed\": " << game.seed << ", \"died\": " << (game.died ? "true" : "false") << ", \"wave\": " << game.wave
+             << ", \"ticks\": " << game.ticks << ", \"peak_bullets\": " << game.peak_bullets << ", \"peak_entities\": " << game.peak_entities
+             << ", \"mean_tick_us\": " << game.mean_tick_us << ", \"p99_tick_us\": " << game.p99_tick_us << ", \"max_tick_us\": " << game.max_tick_us
+             << "}" << (i + 1 != int(games.size()) ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+}
+
+int main(int argc, char* argv[]){
+
+    // options
+    int game_count = 100;
+    unsigned int first_seed = 1;
+    int thread_count = max(1u, thread::hardware_concurrency());
+    long long max_ticks = 30LL * 60 * TICKS_PER_SECOND;
+    string bot_kind = "random";
+    string config_path = "config/game.cfg";
+    string state_path;
+    string csv_path;
+    string json_path;
+    long long check_saves_tick = -1;
+
+    for (int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if (i + 1 == argc){
+            cout << "Missing value for " << arg << "\n";
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--games"){
+            game_count = stoi(value);
+        } else if (arg == "--seed"){
+            first_seed = stoul(value);
+        } else if (arg == "--threads"){
+            thread_count = max(1, stoi(value));
+        } else if (arg == "--ticks"){
+            max_ticks = stoll(value);
+        } else if (arg == "--bot"){
+            bot_kind = value;
+        } else if (arg == "--config"){
+            config_path = value;
+        } else if (arg == "--state"){
+            state_path = value;
+        } else if (arg == "--csv"){
+            csv_path = value;
+        } else if (arg == "--json"){
+            json_path = value;
+        } else if (arg == "--check-saves"){
+            check_saves_tick = max(1LL, stoll(value));
+        } else {
+            cout << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+    if (bot_kind != "random" && bot_kind != "chase"){
+        cout << "Unknown bot: " << bot_kind << "\n";
+        return 1;
+    }
+
+    ConfigSections config;
+    parseConfig(config_path, config);
+
+    // starting state, read once and shared by every game
+    vector<Uint8> state;
+    if (!state_path.empty()){
+        ifstream state_file(state_path, ios::binary);
+        if (!state_file){
+            cout << "Couldn't open save state: " << state_path << "\n";
+            return 1;
+        }
+        state.assign(istreambuf_iterator<char>(state_file), istreambuf_iterator<char>());
+    }
+
+    // every thread takes the next game until there are none left
+    vector<GameStats> games(game_count);
+    atomic<int> next_game(0);
+    vector<thread> threads;
+    auto start = chrono::steady_clock::now();
+    for (int t = 0; t != thread_count; t++){
+        threads.push_back(thread([&](){
+            for (int game = next_game++; game < game_count; game = next_game++){
+                games[game] = runGame(first_seed + game, bot_kind, max_ticks, config, state, check_saves_tick);
+            }
+        }));
+    }
+    for (thread &worker: threads){
+        worker.join();
+    }
+    float seconds = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+
+    // peaks for every wave over all games
+    vector<WaveStats> waves;
+    for (GameStats &game: games){
+        if (waves.size() < game.waves.size()){
+            waves.resize(game.waves.size());
+        }
+        for (int i = 0; i != int(game.waves.size()); i++){
+            waves[i].games += game.waves[i].games;
+            waves[i].peak_bullets = max(waves[i].peak_bullets, game.waves[i].peak_bullets);
+            waves[i].peak_entities = max(waves[i].peak_entities, game.waves[i].peak_entities);
+            waves[i].peak_enemies = max(waves[i].peak_enemies, game.waves[i].peak_enemies);
+            waves[i].max_tick_us = max(waves[i].max_tick_us, game.waves[i].max_tick_us);
+        }
+    }
+
+    // summary
+    long long total_ticks = 0;
+    int max_wave = 0;
+    double total_wave = 0;
+    for (GameStats &game: games){
+        total_ticks += game.ticks;
+        max_wave = max(max_wave, game.wave);
+        total_wave += game.wave;
+    }
+    cout << game_count << " games (" << bot_kind << " bot) on " << thread_count << " threads in " << seconds << "s, "
+         << total_ticks / max(seconds, 0.001f) << " ticks/s\n";
+    cout << "waves: mean " << total_wave / max(game_count, 1) << ", max " << max_wave << "\n";
+    cout << "wave  games  peak bullets  peak entities  peak enemies  max tick us\n";
+    for (int i = 0; i != int(waves.size()); i++){
+        cout << i + 1 << "  " << waves[i].games << "  " << waves[i].peak_bullets << "  " << waves[i].peak_entities
+             << "  " << waves[i].peak_enemies << "  " << waves[i].max_tick_us << "\n";
+    }
+
+    if (!csv_path.empty()){
+        writeCsv(csv_path, games);
+    }
+    if (!json_path.empty()){
+        writeJson(json_path, games, waves, bot_kind);
+    }
+
+    // loaded copies that didn't carry on exactly like the game they were saved from
+    if (check_saves_tick > 0){
+        int diverged = 0;
+        for (GameStats &game: games){
+            if (game.save_diverged_after >= 0){
+                cout << "seed " << game.seed << ": loaded save differs " << game.save_diverged_after << " ticks after loading\n";
+                diverged += 1;
+            }
+        }
+        cout << "save check: " << diverged << " of " << game_count << " games diverged after loading\n";
+        if (diverged){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// g++ batch.cpp -O2 -I"SDL2/include" -L"SDL2/lib" -L"SDL2_image/lib" -Wall -lmingw32 -lSDL2main -lSDL2 -lSDL2_image -o batch
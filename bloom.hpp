@@ -0,0 +1,183 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "SDL2/include/SDL2/SDL.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "functions.hpp"
+#include "game-classes.hpp"
+#include "render-backend.hpp"
+
+using namespace std;
+
+#pragma once
+
+// low resolution bloom buffer, replaces drawing one glow sprite per bullet / particle.
+// glows are splatted into a small intensity buffer, blurred with a separable 9 tap kernel
+// and added over the scene with a single texture copy, so the cost depends on resolution only.
+
+const int BLOOM_RADIUS = 4;
+const Uint16 BLOOM_WEIGHTS[2 * BLOOM_RADIUS + 1] = {1, 8, 28, 56, 70, 56, 28, 8, 1}; // binomial, adds up to 256
+
+class Bloom{
+    public:
+        // buffer variables
+        int width;
+        int height;
+        int scale;
+        int stride;
+        vector<Uint16> buffer;
+        vector<Uint16> temp_buffer;
+
+        // look
+        float intensity;
+        Uint8 r = 255;
+        Uint8 g = 255;
+        Uint8 b = 255;
+
+        // sdl variables
+        SDL_Texture *texture;
+        SDL_Rect rect;
+
+        // methods
+        Bloom(RenderBackend &render, int screen_width_, int screen_height_, int scale_, float intensity_);
+        void clear();
+        void addGlow(float x, float y, float size, int alpha);
+        void blur();
+        void render(RenderBackend &render, Camera &camera);
+        void blurRows(const Uint16 *source, Uint16 *dest);
+        void blurColumns(const Uint16 *source, Uint16 *dest);
+};
+
+Bloom::Bloom(RenderBackend &render, int screen_width_, int screen_height_, int scale_ = 4, float intensity_ = 0.8f){
+    // buffer size (padded by the blur radius on every side, rows rounded up to 8 pixels for simd)
+    scale = scale_;
+    width = (screen_width_ + scale - 1) / scale;
+    height = (screen_height_ + scale - 1) / scale;
+    stride = (width + 2 * BLOOM_RADIUS + 7) / 8 * 8;
+    buffer.assign(stride * (height + 2 * BLOOM_RADIUS), 0);
+    temp_buffer.assign(stride * (height + 2 * BLOOM_RADIUS), 0);
+
+    intensity = intensity_;
+
+    // texture, stretched over the whole screen
+    texture = render.createStreamingTexture(width, height);
+    render.setBlendMode(texture, SDL_BLENDMODE_ADD);
+    rect = {0, 0, width * scale, height * scale};
+}
+
+void Bloom::clear(){
+    // padding is written to by the blur, so clear everything
+    fill(buffer.begin(), buffer.end(), 0);
+}
+
+void Bloom::addGlow(float x, float y, float size, int alpha){
+    // same size as the old glow sprite (size is the diameter)
+    float center_x = x / scale;
+    float center_y = y / scale;
+    float radius = max(size * 0.5f / scale, 1.0f);
+    float value = alpha * intensity;
+
+    int min_x = max(int(center_x - radius), 0);
+    int max_x = min(int(center_x + radius), width - 1);
+    int min_y = max(int(center_y - radius), 0);
+    int max_y = min(int(center_y + radius), height - 1);
+
+    for (int py = min_y; py <= max_y; py++){
+        Uint16 *row = &buffer[(py + BLOOM_RADIUS) * stride + BLOOM_RADIUS];
+        for (int px = min_x; px <= max_x; px++){
+
+            // linear falloff towards the edge
+            float dist = hypot(px + 0.5f - center_x, py + 0.5f - center_y);
+            if (dist < radius){
+                int added = row[px] + int(value * (1 - dist / radius));
+                row[px] = min(added, 255);
+            }
+        }
+    }
+}
+
+void Bloom::blurRows(const Uint16 *source, Uint16 *dest){
+    for (int y = BLOOM_RADIUS; y != height + BLOOM_RADIUS; y++){
+        const Uint16 *in = source + y * stride;
+        Uint16 *out = dest + y * stride + BLOOM_RADIUS;
+        int x = 0;
+
+#ifdef __SSE2__
+        for (; x + 8 <= stride - 2 * BLOOM_RADIUS; x += 8){
+            __m128i sum = _mm_setzero_si128();
+            for (int k = 0; k != 2 * BLOOM_RADIUS + 1; k++){
+                __m128i pixels = _mm_loadu_si128((const __m128i*)(in + x + k));
+                sum = _mm_add_epi16(sum, _mm_mullo_epi16(pixels, _mm_set1_epi16(BLOOM_WEIGHTS[k])));
+            }
+            _mm_storeu_si128((__m128i*)(out + x), _mm_srli_epi16(sum, 8));
+        }
+#endif
+
+        for (; x < width; x++){
+            Uint16 sum = 0;
+            for (int k = 0; k != 2 * BLOOM_RADIUS + 1; k++){
+                sum += in[x + k] * BLOOM_WEIGHTS[k];
+            }
+            out[x] = sum >> 8;
+        }
+    }
+}
+
+void Bloom::blurColumns(const Uint16 *source, Uint16 *dest){
+    for (int y = BLOOM_RADIUS; y != height + BLOOM_RADIUS; y++){
+        const Uint16 *in = source + (y - BLOOM_RADIUS) * stride + BLOOM_RADIUS;
+        Uint16 *out = dest + y * stride + BLOOM_RADIUS;
+        int x = 0;
+
+#ifdef __SSE2__
+        for (; x + 8 <= stride - 2 * BLOOM_RADIUS; x += 8){
+            __m128i sum = _mm_setzero_si128();
+            for (int k = 0; k != 2 * BLOOM_RADIUS + 1; k++){
+                __m128i pixels = _mm_loadu_si128((const __m128i*)(in + k * stride + x));
+                sum = _mm_add_epi16(sum, _mm_mullo_epi16(pixels, _mm_set1_epi16(BLOOM_WEIGHTS[k])));
+            }
+            _mm_storeu_si128((__m128i*)(out + x), _mm_srli_epi16(sum, 8));
+        }
+#endif
+
+        for (; x < width; x++){
+            Uint16 sum = 0;
+            for (int k = 0; k != 2 * BLOOM_RADIUS + 1; k++){
+                sum += in[k * stride + x] * BLOOM_WEIGHTS[k];
+            }
+            out[x] = sum >> 8;
+        }
+    }
+}
+
+void Bloom::blur(){
+    // horizontal into the temp buffer, then vertical back into the buffer
+    blurRows(buffer.data(), temp_buffer.data());
+    blurColumns(temp_buffer.data(), buffer.data());
+}
+
+void Bloom::render(RenderBackend &render, Camera &camera){
+    void *pixels;
+    int pitch;
+    if (!render.lockTexture(texture, &pixels, &pitch)){
+        return;
+    }
+
+    // intensity goes into alpha, additive blending does the rest
+    Uint32 color = (Uint32(r) << 16) | (Uint32(g) << 8) | Uint32(b);
+    for (int y = 0; y != height; y++){
+        const Uint16 *in = &buffer[(y + BLOOM_RADIUS) * stride + BLOOM_RADIUS];
+        Uint32 *out = (Uint32*)((Uint8*)pixels + y * pitch);
+        for (int x = 0; x != width; x++){
+            out[x] = (Uint32(in[x]) << 24) | color;
+        }
+    }
+    render.unlockTexture(texture);
+
+    camera.renderCopy(render, texture, NULL, &rect);
+}
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <string>
+#include <random>
+#include <cmath>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "world.hpp"
+
+using namespace std;
+
+#pragma once
+
+// plays a headless world (batch runs, offline captures). it gets through the menu and death screen by
+// pressing return, then either random walks or stays under the nearest enemy.
+
+class Bot{
+    public:
+        string kind;
+        default_random_engine rand_generator;
+        int next_turn_ticks = 0;
+        int x_dir = 0;
+        int y_dir = 0;
+
+        // methods
+        Bot(string kind_, unsigned int seed);
+        void input(World &world, WorldInput &input);
+};
+
+Bot::Bot(string kind_, unsigned int seed){
+    kind = kind_;
+    rand_generator.seed(seed ^ 0x9e3779b9);
+}
+
+void Bot::input(World &world, WorldInput &input){
+    // get through the menu and straight into the game
+    if (world.game_state != PLAYING){
+        if (world.game_ticks % 2 == 0){
+            input.pressed.push_back(SDLK_RETURN);
+        }
+        return;
+    }
+
+    if (kind == "chase"){
+        // stay near the bottom, under the closest enemy
+        float target_x = 300;
+        float closest = 1e9;
+        world.entities.each<Position, EnemyInfo>([&](Entity entity, Position &position, EnemyInfo &info){
+            float dist = abs(float(position.x) - world.player.x);
+            if (dist < closest){
+                closest = dist;
+                target_x = float(position.x);
+            }
+        });
+        input.left = target_x < world.player.x - 5;
+        input.right = target_x > world.player.x + 5;
+        input.down = world.player.y < 600;
+        input.up = world.player.y > 640;
+        return;
+    }
+
+    // random walk, new direction every so often
+    if (!next_turn_ticks){
+        uniform_int_distribution<int> dir(-1, 1);
+        uniform_int_distribution<int> ticks(20, 90);
+        x_dir = dir(rand_generator);
+        y_dir = dir(rand_generator);
+        next_turn_ticks = ticks(rand_generator);
+    }
+    next_turn_ticks -= 1;
+    input.left = x_dir < 0;
+    input.right = x_dir > 0;
+    input.up = y_dir < 0;
+    input.down = y_dir > 0;
+}
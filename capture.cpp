@@ -0,0 +1,445 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstdio>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+#include "SDL2/include/SDL2/SDL.h"
+#include "SDL2/include/SDL2/SDL_image.h"
+
+#include "render-backend.hpp"
+#include "audio.hpp"
+#include "config.hpp"
+#include "world.hpp"
+#include "save-state.hpp"
+#include "bot.hpp"
+
+using namespace std;
+
+// plays a seeded run headlessly and records it, as fast as it can go rather than at the game's pace. for
+// trailers, and for checking heavy scenes still look right (capture the same seed before and after a change
+// and compare the frames).
+//
+// the world is drawn by the software renderer into a surface in memory (no window), read back every frame
+// and handed to worker threads, which convert / encode it. y4m and raw frames are written in order by a
+// writer thread, pngs are saved by the workers themselves. the main thread only ticks and draws, it waits
+// when every frame buffer is still being encoded.
+//
+// capture --seed 7 --bot chase --skip 2400 --frames 1200 --y4m - | ffmpeg -i - trailer.mp4
+//     --frames N     frames to capture (default 600)
+//     --fps F        frames a second of video, the world ticks 120 times a second of it (default 60)
+//     --skip T       ticks to run before capturing starts (default 0)
+//     --seed S       seed for the world and the bot (default 1)
+//     --bot B        random (random walk) or chase (stays under the nearest enemy)
+//     --config PATH  enemy / wave config (default config/game.cfg)
+//     --state PATH   start from this save state (random generator reseeded)
+//     --threads T    encoding threads (default every core but one)
+//     --y4m PATH     yuv 4:2:0 (full range) video, - for stdout
+//     --raw PATH     frames as they are (4 bytes a pixel, b g r x, 600x700), - for stdout
+//     --png DIR      one png a frame, DIR/frame000000.png on
+
+const int TICKS_PER_SECOND = 120;
+const int CAPTURE_WIDTH = 600;
+const int CAPTURE_HEIGHT = 700;
+const int CAPTURE_BUFFERS_PER_THREAD = 2;
+
+enum FrameState{
+    FRAME_FREE,
+    FRAME_QUEUED, // waiting for a worker
+    FRAME_ENCODING,
+    FRAME_ENCODED // waiting for the writer
+};
+
+struct CapturedFrame{
+    FrameState state = FRAME_FREE;
+    long long number = 0;
+    vector<Uint8> pixels;
+    vector<Uint8> encoded;
+};
+
+class FrameEncoder{
+    public:
+        string format; // y4m, raw or png
+        string path;
+        int width;
+        int height;
+        int fps;
+        FILE *file = NULL;
+        bool failed = false;
+
+        // frame n goes in frames[n % size], so the writer frees them in the order they're filled
+        vector<CapturedFrame> frames;
+        deque<int> queued;
+        long long next_frame = 0;
+        long long next_write = 0;
+        bool finishing = false;
+        mutex frames_mutex;
+        condition_variable frames_changed;
+
+        vector<thread> workers;
+        thread writer;
+
+        // how long the main thread waited for a free buffer
+        double waited_ms = 0;
+
+        // methods
+        FrameEncoder(string format_, string path_, int width_, int height_, int fps_, int thread_count);
+        ~FrameEncoder();
+        Uint8* nextBuffer();
+        void submit();
+        void finish();
+        void encodeFrames();
+        void writeFrames();
+        void encode(CapturedFrame &frame);
+        void toYuv420(const Uint8 *pixels, vector<Uint8> &out);
+};
+
+FrameEncoder::FrameEncoder(string format_, string path_, int width_, int height_, int fps_, int thread_count){
+    format = format_;
+    path = path_;
+    width = width_;
+    height = height_;
+    fps = fps_;
+
+    // output
+    if (format == "png"){
+        error_code error;
+        filesystem::create_directories(path, error);
+        if (error){
+            cout << "Couldn't make " << path << "\n";
+            failed = true;
+        }
+    } else if (path == "-"){
+        #ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+        #endif
+        file = stdout;
+    } else {
+        file = fopen(path.c_str(), "wb");
+        if (file == NULL){
+            cout << "Couldn't write " << path << "\n";
+            failed = true;
+        }
+    }
+    if (format == "y4m" && file != NULL){
+        fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps);
+    }
+
+    frames.resize(thread_count * CAPTURE_BUFFERS_PER_THREAD);
+    for (CapturedFrame &frame : frames){
+        frame.pixels.resize(size_t(width) * height * 4);
+    }
+    for (int i = 0; i != thread_count; i++){
+        workers.push_back(thread(&FrameEncoder::encodeFrames, this));
+    }
+    writer = thread(&FrameEncoder::writeFrames, this);
+}
+
+FrameEncoder::~FrameEncoder(){
+    finish();
+}
+
+Uint8* FrameEncoder::nextBuffer(){
+    // waits until the frame that used this buffer last has been written
+    auto start = chrono::steady_clock::now();
+    unique_lock<mutex> lock(frames_mutex);
+    CapturedFrame &frame = frames[next_frame % frames.size()];
+    frames_changed.wait(lock, [&](){ return frame.state == FRAME_FREE; });
+    waited_ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return frame.pixels.data();
+}
+
+void FrameEncoder::submit(){
+    // the buffer from nextBuffer() has been filled
+    {
+        lock_guard<mutex> lock(frames_mutex);
+        int index = next_frame % frames.size();
+        frames[index].state = FRAME_QUEUED;
+        frames[index].number = next_frame;
+        queued.push_back(index);
+        next_frame += 1;
+    }
+    frames_changed.notify_all();
+}
+
+void FrameEncoder::finish(){
+    // everything submitted is encoded and written before this returns
+    {
+        lock_guard<mutex> lock(frames_mutex);
+        finishing = true;
+    }
+    frames_changed.notify_all();
+    for (thread &worker : workers){
+        if (worker.joinable()){
+            worker.join();
+        }
+    }
+    if (writer.joinable()){
+        writer.join();
+    }
+    if (file != NULL){
+        fflush(file);
+        if (file != stdout){
+            fclose(file);
+        }
+        file = NULL;
+    }
+}
+
+void FrameEncoder::encodeFrames(){
+    // worker thread
+    while (true){
+        int index;
+        {
+            unique_lock<mutex> lock(frames_mutex);
+            frames_changed.wait(lock, [&](){ return !queued.empty() || finishing; });
+            if (queued.empty()){
+                return;
+            }
+            index = queued.front();
+            queued.pop_front();
+            frames[index].state = FRAME_ENCODING;
+        }
+
+        encode(frames[index]);
+
+        {
+            lock_guard<mutex> lock(frames_mutex);
+            frames[index].state = FRAME_ENCODED;
+        }
+        frames_changed.notify_all();
+    }
+}
+
+void FrameEncoder::writeFrames(){
+    // writer thread, frames in the order they were submitted
+    while (true){
+        CapturedFrame *frame;
+        {
+            unique_lock<mutex> lock(frames_mutex);
+            frame = &frames[next_write % frames.size()];
+            frames_changed.wait(lock, [&](){ return (frame -> state == FRAME_ENCODED && frame -> number == next_write) || (finishing && next_write == next_frame); });
+            if (frame -> state != FRAME_ENCODED || frame -> number != next_write){
+                return;
+            }
+        }
+
+        if (file != NULL && !failed){
+            const vector<Uint8> &bytes = (format == "raw") ? frame -> pixels : frame -> encoded;
+            if (format == "y4m"){
+                fputs("FRAME\n", file);
+            }
+            if (fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size()){
+                cout << "Couldn't write " << path << "\n";
+                failed = true;
+            }
+        }
+
+        {
+            lock_guard<mutex> lock(frames_mutex);
+            frame -> state = FRAME_FREE;
+            next_write += 1;
+        }
+        frames_changed.notify_all();
+    }
+}
+
+void FrameEncoder::encode(CapturedFrame &frame){
+    if (format == "y4m"){
+        toYuv420(frame.pixels.data(), frame.encoded);
+    } else if (format == "png"){
+        char name[32];
+        snprintf(name, sizeof(name), "frame%06lld.png", frame.number);
+        string frame_path = (filesystem::path(path) / name).string();
+        SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom(frame.pixels.data(), width, height, 32, width * 4, SDL_PIXELFORMAT_RGB888);
+        if (surface == NULL || IMG_SavePNG(surface, frame_path.c_str()) != 0){
+            cout << "Couldn't write " << frame_path << "\n";
+        }
+        SDL_FreeSurface(surface);
+    }
+}
+
+void FrameEncoder::toYuv420(const Uint8 *pixels, vector<Uint8> &out){
+    // bt.601 full range (what C420jpeg means), chroma from the average of each 2x2 block.
+    // fixed point, 8 fractional bits, chroma offset by 128 << 8 so nothing is shifted while negative
+    int chroma_width = (width + 1) / 2;
+    int chroma_height = (height + 1) / 2;
+    out.resize(size_t(width) * height + 2 * size_t(chroma_width) * chroma_height);
+    Uint8 *y_plane = out.data();
+    Uint8 *u_plane = y_plane + size_t(width) * height;
+    Uint8 *v_plane = u_plane + size_t(chroma_width) * chroma_height;
+
+    const Uint32 *rows = (const Uint32*)pixels;
+    for (int cy = 0; cy != chroma_height; cy++){
+        for (int cx = 0; cx != chroma_width; cx++){
+            int r_sum = 0, g_sum = 0, b_sum = 0, count = 0;
+            for (int y = cy * 2; y != min(cy * 2 + 2, height); y++){
+                for (int x = cx * 2; x != min(cx * 2 + 2, width); x++){
+                    Uint32 pixel = rows[y * width + x];
+                    int r = (pixel >> 16) & 255;
+                    int g = (pixel >> 8) & 255;
+                    int b = pixel & 255;
+                    y_plane[y * width + x] = (77 * r + 150 * g + 29 * b + 128) >> 8;
+                    r_sum += r;
+                    g_sum += g;
+                    b_sum += b;
+                    count += 1;
+                }
+            }
+            int r = r_sum / count;
+            int g = g_sum / count;
+            int b = b_sum / count;
+            u_plane[cy * chroma_width + cx] = min(255, (-43 * r - 85 * g + 128 * b + 32896) >> 8);
+            v_plane[cy * chroma_width + cx] = min(255, (128 * r - 107 * g - 21 * b + 32896) >> 8);
+        }
+    }
+}
+
+int main(int argc, char* argv[]){
+
+    // options
+    int frame_count = 600;
+    int fps = 60;
+    long long skip_ticks = 0;
+    unsigned int seed = 1;
+    string bot_kind = "random";
+    string config_path = "config/game.cfg";
+    string state_path;
+    int thread_count = max(1, int(thread::hardware_concurrency()) - 1);
+    string format;
+    string output_path;
+
+    for (int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if (i + 1 == argc){
+            cout << "Missing value for " << arg << "\n";
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--frames"){
+            frame_count = stoi(value);
+        } else if (arg == "--fps"){
+            fps = max(1, stoi(value));
+        } else if (arg == "--skip"){
+            skip_ticks = stoll(value);
+        } else if (arg == "--seed"){
+            seed = stoul(value);
+        } else if (arg == "--bot"){
+            bot_kind = value;
+        } else if (arg == "--config"){
+            config_path = value;
+        } else if (arg == "--state"){
+            state_path = value;
+        } else if (arg == "--threads"){
+            thread_count = max(1, stoi(value));
+        } else if (arg == "--y4m" || arg == "--raw" || arg == "--png"){
+            format = arg.substr(2);
+            output_path = value;
+        } else {
+            cout << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+    if (bot_kind != "random" && bot_kind != "chase"){
+        cout << "Unknown bot: " << bot_kind << "\n";
+        return 1;
+    }
+    if (format.empty()){
+        cout << "Nothing to write to, use --y4m, --raw or --png\n";
+        return 1;
+    }
+
+    // progress goes to stderr when the video is going to stdout
+    ostream &progress = (output_path == "-") ? cerr : cout;
+
+    // a software renderer drawing into memory, nothing is shown
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, CAPTURE_WIDTH, CAPTURE_HEIGHT, 32, SDL_PIXELFORMAT_RGB888);
+    SDL_Renderer *renderer = (surface != NULL) ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    if (renderer == NULL){
+        cout << "Couldn't make a renderer: " << SDL_GetError() << "\n";
+        return 1;
+    }
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+
+    {
+        SDLRender render(renderer);
+        SilentAudio audio;
+        World world(render, audio, seed, 1000.0f / TICKS_PER_SECOND);
+        ConfigSections config;
+        parseConfig(config_path, config);
+        world.applyConfig(config);
+
+        if (!state_path.empty()){
+            ifstream state_file(state_path, ios::binary);
+            if (!state_file){
+                cout << "Couldn't open save state: " << state_path << "\n";
+                return 1;
+            }
+            vector<Uint8> state((istreambuf_iterator<char>(state_file)), istreambuf_iterator<char>());
+            if (loadWorld(world, state.data(), state.size())){
+                world.rand_generator.seed(seed);
+            }
+        }
+        Bot bot(bot_kind, seed);
+
+        auto tick = [&](){
+            WorldInput input;
+            bot.input(world, input);
+            world.update(input);
+        };
+        for (long long i = 0; i != skip_ticks && world.running; i++){
+            tick();
+        }
+
+        FrameEncoder encoder(format, output_path, CAPTURE_WIDTH, CAPTURE_HEIGHT, fps, thread_count);
+        if (encoder.failed){
+            return 1;
+        }
+
+        auto start = chrono::steady_clock::now();
+        double render_ms = 0;
+        int frames = 0;
+        for (; frames != frame_count && world.running && !encoder.failed; frames++){
+
+            // ticks up to where this frame is in the video
+            long long ticks = (long long)(frames + 1) * TICKS_PER_SECOND / fps - (long long)frames * TICKS_PER_SECOND / fps;
+            for (long long i = 0; i != ticks; i++){
+                tick();
+            }
+
+            auto render_start = chrono::steady_clock::now();
+            render.clear();
+            world.render();
+            SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_RGB888, encoder.nextBuffer(), CAPTURE_WIDTH * 4);
+            render_ms += chrono::duration<double, milli>(chrono::steady_clock::now() - render_start).count();
+            encoder.submit();
+
+            if ((frames + 1) % (fps * 10) == 0){
+                progress << frames + 1 << " frames\n";
+            }
+        }
+        encoder.finish();
+
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        progress << frames << " frames (" << float(frames) / fps << "s of video) in " << seconds << "s, "
+            << frames / max(seconds, 0.001) << " fps, " << float(frames) / fps / max(seconds, 0.001) << "x real time\n";
+        progress << "drawing " << render_ms / max(frames, 1) << "ms a frame, waited for encoders " << encoder.waited_ms / max(frames, 1)
+            << "ms a frame (" << thread_count << " threads)\n";
+    }
+
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return 0;
+}
+
+// g++ capture.cpp -O2 -I"SDL2/include" -L"SDL2/lib" -L"SDL2_image/lib" -Wall -lmingw32 -lSDL2main -lSDL2 -lSDL2_image -o capture
@@ -0,0 +1,297 @@
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "functions.hpp"
+#include "animation.hpp"
+#include "ecs.hpp"
+#include "fixed-point.hpp"
+
+using namespace std;
+
+#pragma once
+
+// components (plain data, see ecs.hpp) and the functions that put together each kind of entity
+
+// sprite layers, drawn in this order
+const int LAYER_MISSILES = 0;
+const int LAYER_PARTICLES = 1;
+const int LAYER_ENEMY_ATTACKS = 2;
+const int LAYER_ENEMIES = 3;
+const int LAYER_EXPLOSIONS = 4;
+
+struct Position{
+    static const int ID = 0;
+    Scalar x;
+    Scalar y;
+};
+
+struct Velocity{
+    static const int ID = 1;
+    Scalar x;
+    Scalar y;
+};
+
+struct Size{
+    static const int ID = 2;
+    Scalar width;
+    Scalar height;
+};
+
+struct Sprite{
+    static const int ID = 3;
+    Animation animation;
+    int layer;
+    int alpha;
+};
+
+struct Gravity{
+    static const int ID = 4;
+    Scalar gravity;
+};
+
+// loses alpha every tick, removed once invisible
+struct Fade{
+    static const int ID = 5;
+    int lose_alpha;
+};
+
+// gains alpha every tick until fully visible
+struct FadeIn{
+    static const int ID = 6;
+    int speed;
+};
+
+struct Glow{
+    static const int ID = 7;
+    float radius;
+    float min;
+    float max;
+    int direction; // 0 = doesn't pulse
+    int quality; // lowest glow quality level it is still shown at
+};
+
+// removed once outside
+struct Bounds{
+    static const int ID = 8;
+    Scalar min_x;
+    Scalar min_y;
+    Scalar max_x;
+    Scalar max_y;
+};
+
+// removed once its animation has played
+struct OneShot{
+    static const int ID = 9;
+};
+
+struct PlayerShot{
+    static const int ID = 10;
+    int damage;
+};
+
+struct EnemyShot{
+    static const int ID = 11;
+    int damage;
+};
+
+struct Health{
+    static const int ID = 12;
+    int health;
+};
+
+// moves to random targets (ticks it's woken at, see timer-wheel.hpp)
+struct Wander{
+    static const int ID = 13;
+    Scalar speed;
+    Uint32 move_tick; // starts moving (once faded in)
+    Uint32 arrive_tick; // stops
+    Uint32 next_move_tick; // picks the next target
+    Scalar x_vel;
+    Scalar y_vel;
+};
+
+// shoots rings / sprays of bullets
+struct Shooter{
+    static const int ID = 14;
+    Scalar rotation;
+    Scalar rotation_vel;
+    Scalar xvel_mult;
+    Scalar yvel_mult;
+    int shot_num;
+    Uint32 next_shot_tick;
+    int cooldown;
+    Uint32 attack_clip;
+    int attack_width;
+    int attack_height;
+    int attack_damage;
+};
+
+struct EnemyInfo{
+    static const int ID = 15;
+    int type;
+    int boss; // 0 or 1
+};
+
+// leaves a trail of particles
+struct Trail{
+    static const int ID = 16;
+};
+
+// bullets flying around behind the menu
+struct MenuDecoration{
+    static const int ID = 17;
+};
+
+// flies in a straight line from where it was fired. nothing moves it, where it is gets worked out when
+// it's drawn or checked against the player (trajectoryPosition), and it's removed at exit_tick, the tick
+// it's left the screen by (worked out when it's fired, see timer-wheel.hpp)
+struct Trajectory{
+    static const int ID = 18;
+    Scalar x;
+    Scalar y;
+    Scalar x_vel;
+    Scalar y_vel;
+    Uint32 spawn_tick;
+    Uint32 exit_tick;
+};
+
+// size of every component by ID, save states are only loaded if these still match
+const int COMPONENT_COUNT = 19;
+const int COMPONENT_SIZES[COMPONENT_COUNT] = {
+    sizeof(Position), sizeof(Velocity), sizeof(Size), sizeof(Sprite), sizeof(Gravity), sizeof(Fade),
+    sizeof(FadeIn), sizeof(Glow), sizeof(Bounds), sizeof(OneShot), sizeof(PlayerShot), sizeof(EnemyShot),
+    sizeof(Health), sizeof(Wander), sizeof(Shooter), sizeof(EnemyInfo), sizeof(Trail), sizeof(MenuDecoration),
+    sizeof(Trajectory),
+};
+
+SDL_Rect entityRect(Position &position, Size &size){
+    SDL_Rect rect = {int(position.x), int(position.y), int(size.width), int(size.height)};
+    centerRect(rect);
+    return rect;
+}
+
+// anything still on screen this long after being fired (about 4 minutes, only very slow bullets) goes anyway
+const int TRAJECTORY_MAX_TICKS = 30000;
+
+Position trajectoryPosition(Trajectory &trajectory, Uint32 tick){
+    // at the start of tick (it moves once a tick, the first time on the tick it's fired)
+    Scalar ticks = Scalar(int(tick - trajectory.spawn_tick));
+    return {trajectory.x + trajectory.x_vel * ticks, trajectory.y + trajectory.y_vel * ticks};
+}
+
+bool trajectoryOnScreen(Trajectory &trajectory, Uint32 tick){
+    Position position = trajectoryPosition(trajectory, tick);
+    return position.x > -100 && position.x < 700 && position.y > -100 && position.y < 800;
+}
+
+Uint32 trajectoryExitTick(Trajectory &trajectory){
+    // first tick it starts off screen: guessed from the edge it gets to first, then nudged so it agrees
+    // with trajectoryPosition exactly (it's a straight line, so once off it stays off)
+    float ticks = TRAJECTORY_MAX_TICKS;
+    auto edge = [&](Scalar position, Scalar velocity, float low, float high){
+        if (velocity > 0){
+            ticks = min(ticks, (high - float(position)) / float(velocity));
+        } else if (velocity < 0){
+            ticks = min(ticks, (low - float(position)) / float(velocity));
+        }
+    };
+    edge(trajectory.x, trajectory.x_vel, -100, 700);
+    edge(trajectory.y, trajectory.y_vel, -100, 800);
+
+    Uint32 exit_tick = trajectory.spawn_tick + max(int(ceil(ticks)), 0);
+    while (exit_tick != trajectory.spawn_tick && !trajectoryOnScreen(trajectory, exit_tick - 1)){
+        exit_tick -= 1;
+    }
+    while (exit_tick - trajectory.spawn_tick < Uint32(TRAJECTORY_MAX_TICKS) && trajectoryOnScreen(trajectory, exit_tick)){
+        exit_tick += 1;
+    }
+    return exit_tick;
+}
+
+Entity createParticle(EntityRegistry &entities, Animation animation, Scalar x, Scalar y, Scalar x_vel, Scalar y_vel, int alpha, Scalar width, Scalar height, Scalar gravity = 0, int lose_alpha = 6){
+    return entities.create(
+        Position{x, y},
+        Velocity{x_vel, y_vel},
+        Size{width, height},
+        Sprite{animation, LAYER_PARTICLES, alpha},
+        Gravity{gravity},
+        Fade{lose_alpha},
+        Glow{float(width) * 2, float(width) * 2, float(width) * 2, 0, 2}
+    );
+}
+
+Entity createMissile(EntityRegistry &entities, Animation animation, Scalar x, Scalar y, Scalar speed, int damage){
+    return entities.create(
+        Position{x, y},
+        Velocity{0, -speed},
+        Size{40, 57},
+        Sprite{animation, LAYER_MISSILES, 255},
+        Bounds{-100, -29, 700, 800},
+        PlayerShot{damage}
+    );
+}
+
+Entity createEnemyShot(EntityRegistry &entities, Animation animation, Scalar x, Scalar y, Scalar width, Scalar height, int damage, Scalar xvel, Scalar yvel, Uint32 tick){
+    Trajectory trajectory = {x, y, xvel, yvel, tick, 0};
+    trajectory.exit_tick = trajectoryExitTick(trajectory);
+    return entities.create(
+        trajectory,
+        Size{width, height},
+        Sprite{animation, LAYER_ENEMY_ATTACKS, 255},
+        Glow{float(width) * 2.5f, float(width) * 2, float(width) * 2.5f, -1, 1},
+        EnemyShot{damage}
+    );
+}
+
+Entity createMenuShot(EntityRegistry &entities, Animation animation, Scalar x, Scalar y, Scalar width, Scalar height, Scalar xvel, Scalar yvel){
+    return entities.create(
+        Position{x, y},
+        Velocity{xvel, yvel},
+        Size{width, height},
+        Sprite{animation, LAYER_ENEMY_ATTACKS, 255},
+        Glow{float(width) * 2.5f, float(width) * 2, float(width) * 2.5f, -1, 1},
+        Bounds{-100, -100, 700, 800},
+        MenuDecoration{}
+    );
+}
+
+Entity createExplosion(EntityRegistry &entities, Animation animation, Scalar x, Scalar y, Scalar width = 48, Scalar height = 48){
+    return entities.create(
+        Position{x, y},
+        Size{width, height},
+        Sprite{animation, LAYER_EXPLOSIONS, 255},
+        OneShot{}
+    );
+}
+
+Entity createEnemy(EntityRegistry &entities, unordered_map<string, float> &data, int type, bool boss, bool trail, Animation animation, Uint16 attack_clip, Scalar x, Scalar y, Uint32 tick){
+    Position position = {x, y};
+    Velocity velocity = {0, 0};
+    Size size = {data["width"], data["height"]};
+    Sprite sprite = {animation, LAYER_ENEMIES, 0}; // fades in
+    Health health = {int(data["health"])};
+    Wander wander = {data["speed"], tick, tick, tick, 0, 0}; // first target straight away
+    Shooter shooter = {
+        0,
+        data["attack_rotation_vel"],
+        data["attack_xvel_mult"],
+        data["attack_yvel_mult"],
+        int(data["shot_num"]),
+        tick + max(int(data["shot_cooldown"]), 1),
+        int(data["shot_cooldown"]),
+        attack_clip,
+        int(data["attack_width"]),
+        int(data["attack_height"]),
+        int(data["attack_damage"]),
+    };
+    EnemyInfo info = {type, boss};
+
+    if (trail){
+        return entities.create(position, velocity, size, sprite, FadeIn{3}, health, wander, shooter, info, Trail{});
+    }
+    return entities.create(position, velocity, size, sprite, FadeIn{3}, health, wander, shooter, info);
+}
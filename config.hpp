@@ -0,0 +1,202 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <filesystem>
+#include <windows.h>
+
+using namespace std;
+
+#pragma once
+
+// enemy and wave tuning loaded from a text file, and reloaded while the game runs whenever the file is saved.
+//
+// file format:
+//     # comment
+//     [soldier]
+//     speed 1
+//     shot_cooldown 40
+//
+// every [section] becomes a map of key -> value. the [waves] section holds the spawning constants,
+// every other section is an enemy type. keys missing from the file keep their built in values.
+//
+// a background thread waits for the config directory to change, re-parses the file there and hands the
+// result over. the game only checks one atomic flag per tick, and picks the new values up between ticks.
+
+typedef unordered_map<string, unordered_map<string, float>> ConfigSections;
+
+bool parseConfig(string path, ConfigSections &sections){
+    ifstream file(path);
+    if (!file){
+        cout << "Couldn't open config: " << path << "\n";
+        return false;
+    }
+
+    string line;
+    string section;
+    int line_number = 0;
+    bool ok = true;
+    while (getline(file, line)){
+        line_number += 1;
+
+        // strip comments
+        size_t comment = line.find('#');
+        if (comment != string::npos){
+            line.erase(comment);
+        }
+
+        istringstream words(line);
+        string key;
+        if (!(words >> key)){
+            continue;
+        }
+
+        // new section
+        if (key.front() == '[' && key.back() == ']'){
+            section = key.substr(1, key.size() - 2);
+            continue;
+        }
+
+        float value;
+        string extra;
+        if (section.empty() || !(words >> value) || (words >> extra)){
+            cout << "Bad config line " << path << ":" << line_number << ": " << line << "\n";
+            ok = false;
+            continue;
+        }
+        sections[section][key] = value;
+    }
+    return ok;
+}
+
+// copy every value from into the matching section of sections
+void mergeConfig(ConfigSections &sections, ConfigSections &from){
+    for (auto& [section, values]: from){
+        for (auto& [key, value]: values){
+            sections[section][key] = value;
+        }
+    }
+}
+
+class ConfigWatcher{
+    public:
+        string path;
+        string directory;
+        filesystem::file_time_type last_write;
+
+        thread watcher;
+        atomic<bool> running;
+        atomic<bool> changed;
+        mutex pending_mutex;
+        ConfigSections pending;
+
+        // methods
+        ConfigWatcher(string path_);
+        ~ConfigWatcher();
+        ConfigWatcher(const ConfigWatcher&) = delete;
+        ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+        bool load(ConfigSections &sections);
+        void start();
+        bool poll(ConfigSections &sections);
+        bool writeTime(filesystem::file_time_type &time);
+        void watch();
+};
+
+ConfigWatcher::ConfigWatcher(string path_){
+    path = path_;
+    directory = filesystem::path(path).parent_path().string();
+    if (directory.empty()){
+        directory = ".";
+    }
+    running = false;
+    changed = false;
+}
+
+ConfigWatcher::~ConfigWatcher(){
+    running = false;
+    if (watcher.joinable()){
+        watcher.join();
+    }
+}
+
+bool ConfigWatcher::writeTime(filesystem::file_time_type &time){
+    error_code error;
+    time = filesystem::last_write_time(path, error);
+    return !error;
+}
+
+bool ConfigWatcher::load(ConfigSections &sections){
+    // first load, on the calling thread
+    writeTime(last_write);
+    ConfigSections loaded;
+    bool ok = parseConfig(path, loaded);
+    mergeConfig(sections, loaded);
+    return ok;
+}
+
+void ConfigWatcher::start(){
+    running = true;
+    watcher = thread(&ConfigWatcher::watch, this);
+}
+
+bool ConfigWatcher::poll(ConfigSections &sections){
+    // called once per tick, only locks when there is something new
+    if (!changed.load(memory_order_acquire)){
+        return false;
+    }
+    lock_guard<mutex> lock(pending_mutex);
+    mergeConfig(sections, pending);
+    pending.clear();
+    changed.store(false, memory_order_release);
+    return true;
+}
+
+void ConfigWatcher::watch(){
+    // wakes up when something in the directory is written or renamed (editors often save through a temp file),
+    // or every half second anyway so the thread can be stopped
+    HANDLE notification = FindFirstChangeNotification(directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+    bool notifications = notification != INVALID_HANDLE_VALUE && notification != NULL;
+    if (!notifications){
+        cout << "Couldn't watch " << directory << ", checking " << path << " every half second instead\n";
+    }
+
+    while (running){
+        if (notifications){
+            if (WaitForSingleObject(notification, 500) == WAIT_OBJECT_0){
+                FindNextChangeNotification(notification);
+            }
+        } else {
+            this_thread::sleep_for(chrono::milliseconds(500));
+        }
+
+        // was it this file?
+        filesystem::file_time_type write_time;
+        if (!running || !writeTime(write_time) || write_time == last_write){
+            continue;
+        }
+
+        // let the editor finish writing
+        this_thread::sleep_for(chrono::milliseconds(50));
+        writeTime(write_time);
+        last_write = write_time;
+
+        ConfigSections loaded;
+        if (!parseConfig(path, loaded)){
+            cout << "Config " << path << " has errors, loading the lines that parsed\n";
+        }
+
+        lock_guard<mutex> lock(pending_mutex);
+        mergeConfig(pending, loaded);
+        changed.store(true, memory_order_release);
+        cout << "Reloaded " << path << "\n";
+    }
+
+    if (notifications){
+        FindCloseChangeNotification(notification);
+    }
+}
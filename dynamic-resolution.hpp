@@ -0,0 +1,113 @@
+#include <iostream>
+#include <algorithm>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "game-classes.hpp"
+
+using namespace std;
+
+#pragma once
+
+// the scene is drawn at a fixed logical size (600x700) into an offscreen texture and
+// stretched to the window with a single copy. when frames take too long the part of the
+// texture that is drawn into gets smaller, and grows back once there is time to spare.
+
+class DynamicResolution{
+    public:
+        // logical size, everything in the game uses these coordinates
+        int logical_width;
+        int logical_height;
+
+        // current internal size
+        float scale = 1;
+        float min_scale = 0.5f;
+        float max_scale = 1;
+        float scale_step = 0.05f;
+        int internal_width;
+        int internal_height;
+
+        // frame time tracking
+        float frame_budget;
+        float average_frame_time;
+        int good_frames = 0;
+        int grow_after_frames = 120;
+        int cooldown_frames = 0;
+
+        // sdl variables
+        SDL_Texture *target;
+        SDL_Rect source_rect;
+
+        // methods
+        DynamicResolution(SDL_Renderer *renderer, int logical_width_, int logical_height_, float frame_budget_);
+        void begin(SDL_Renderer *renderer, Camera &camera);
+        void present(SDL_Renderer *renderer);
+        void update(float frame_time);
+        void setScale(float new_scale);
+};
+
+DynamicResolution::DynamicResolution(SDL_Renderer *renderer, int logical_width_, int logical_height_, float frame_budget_){
+    logical_width = logical_width_;
+    logical_height = logical_height_;
+    frame_budget = frame_budget_;
+    average_frame_time = frame_budget * 0.5f;
+
+    // target is allocated at full logical size once, lower resolutions use the top left of it
+    target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, logical_width, logical_height);
+    SDL_SetTextureScaleMode(target, SDL_ScaleModeLinear);
+
+    setScale(max_scale);
+}
+
+void DynamicResolution::setScale(float new_scale){
+    scale = max(min_scale, min(max_scale, new_scale));
+    internal_width = int(logical_width * scale);
+    internal_height = int(logical_height * scale);
+    source_rect = {0, 0, internal_width, internal_height};
+}
+
+void DynamicResolution::begin(SDL_Renderer *renderer, Camera &camera){
+    // draw everything into the target, camera maps logical coordinates to the internal size
+    SDL_SetRenderTarget(renderer, target);
+    camera.scaleBy(internal_width, internal_height, logical_width, logical_height);
+}
+
+void DynamicResolution::present(SDL_Renderer *renderer){
+    // one stretched copy to the window
+    SDL_SetRenderTarget(renderer, NULL);
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, target, &source_rect, NULL);
+}
+
+void DynamicResolution::update(float frame_time){
+    // smoothed frame time (time spent working, not waiting), single hitches are clamped
+    frame_time = min(frame_time, frame_budget * 4);
+    average_frame_time += (frame_time - average_frame_time) * 0.05f;
+
+    if (cooldown_frames){
+        cooldown_frames -= 1;
+        return;
+    }
+
+    if (average_frame_time > frame_budget * 0.9f){
+
+        // too slow, drop resolution straight away
+        if (scale > min_scale){
+            setScale(scale - scale_step);
+            cooldown_frames = 30; // give the average time to catch up
+        }
+        good_frames = 0;
+
+    } else if (average_frame_time < frame_budget * 0.6f){
+
+        // only raise resolution after a while of having time to spare
+        good_frames += 1;
+        if (good_frames >= grow_after_frames && scale < max_scale){
+            setScale(scale + scale_step);
+            good_frames = 0;
+            cooldown_frames = 30;
+        }
+
+    } else {
+        good_frames = 0;
+    }
+}
@@ -0,0 +1,336 @@
+#include <iostream>
+#include <vector>
+#include <tuple>
+#include <cstring>
+#include <type_traits>
+#include <algorithm>
+#include "SDL2/include/SDL2/SDL.h"
+
+using namespace std;
+
+#pragma once
+
+// archetype based entity storage.
+// every combination of components (an archetype) stores its entities in fixed size chunks,
+// and inside a chunk every component has its own column starting on a cache line.
+// systems ask for the components they need with each<A, B, ...>() and walk the columns linearly,
+// so a new kind of entity only needs a new combination of components, not new loops.
+//
+// components are plain structs with a unique static ID (0 - 31), and have to be trivially copyable.
+// they also shouldn't have padding, save states copy whole columns and compare them byte for byte.
+// removing an entity moves the archetype's last entity into the hole, so each() walks backwards and
+// the visited entity can be destroyed safely. don't destroy other entities of the same query inside each().
+// entities created inside each() are not visited by that same each().
+
+const int ECS_CHUNK_BYTES = 16384;
+const int ECS_CACHE_LINE = 64;
+const int ECS_MAX_COMPONENTS = 32;
+const int ECS_STACK_ARCHETYPES = 128; // each() keeps its snapshot on the stack up to this many, on the heap past it
+
+typedef Uint32 ComponentMask;
+
+struct Entity{
+    Uint32 index = 0xFFFFFFFF;
+    Uint32 generation = 0;
+};
+
+struct alignas(ECS_CACHE_LINE) EntityChunk{
+    Uint8 data[ECS_CHUNK_BYTES];
+};
+
+class Archetype{
+    public:
+        ComponentMask mask;
+        vector<int> component_ids;
+        int component_sizes[ECS_MAX_COMPONENTS] = {};
+        int column_offsets[ECS_MAX_COMPONENTS] = {};
+        int entity_offset = 0;
+        int capacity; // entities per chunk
+        int count = 0;
+        vector<EntityChunk*> chunks;
+
+        // methods
+        Archetype(ComponentMask mask_, vector<pair<int, int>> components);
+        ~Archetype();
+        Uint8* column(int chunk, int component_id);
+        Entity* entities(int chunk);
+        int chunkCount(int chunk);
+};
+
+Archetype::Archetype(ComponentMask mask_, vector<pair<int, int>> components){
+    mask = mask_;
+
+    // same mask always gets the same layout, however the components were passed in
+    sort(components.begin(), components.end());
+
+    int row_bytes = sizeof(Entity);
+    for (auto [id, size]: components){
+        component_ids.push_back(id);
+        component_sizes[id] = size;
+        row_bytes += size;
+    }
+
+    // biggest capacity where every column (rounded up to a cache line) still fits in a chunk
+    auto columnBytes = [](int count_, int size){
+        return (count_ * size + ECS_CACHE_LINE - 1) / ECS_CACHE_LINE * ECS_CACHE_LINE;
+    };
+    capacity = ECS_CHUNK_BYTES / row_bytes;
+    while (true){
+        int used = columnBytes(capacity, sizeof(Entity));
+        for (int id: component_ids){
+            used += columnBytes(capacity, component_sizes[id]);
+        }
+        if (used <= ECS_CHUNK_BYTES){
+            break;
+        }
+        capacity -= 1;
+    }
+
+    // column layout
+    int offset = columnBytes(capacity, sizeof(Entity));
+    for (int id: component_ids){
+        column_offsets[id] = offset;
+        offset += columnBytes(capacity, component_sizes[id]);
+    }
+}
+
+Archetype::~Archetype(){
+    for (EntityChunk *chunk: chunks){
+        delete chunk;
+    }
+}
+
+Uint8* Archetype::column(int chunk, int component_id){
+    return chunks[chunk] -> data + column_offsets[component_id];
+}
+
+Entity* Archetype::entities(int chunk){
+    return (Entity*)(chunks[chunk] -> data + entity_offset);
+}
+
+int Archetype::chunkCount(int chunk){
+    return max(0, min(capacity, count - chunk * capacity));
+}
+
+struct EntityRecord{
+    Uint32 generation = 0;
+    int archetype = -1;
+    int row = 0;
+};
+
+template <typename... C>
+ComponentMask componentMask(){
+    return (ComponentMask(0) | ... | (ComponentMask(1) << C::ID));
+}
+
+class EntityRegistry{
+    public:
+        vector<Archetype*> archetypes;
+        vector<EntityRecord> records;
+        vector<Uint32> free_records;
+        int entity_count = 0;
+
+        // methods
+        EntityRegistry();
+        ~EntityRegistry();
+        EntityRegistry(const EntityRegistry&) = delete;
+        EntityRegistry& operator=(const EntityRegistry&) = delete;
+
+        template <typename... C> Entity create(C... components);
+        void destroy(Entity entity);
+        bool valid(Entity entity);
+        template <typename C> bool has(Entity entity);
+        template <typename C> C* get(Entity entity);
+        template <typename... C, typename F> void each(F function);
+        template <typename... C> int count();
+        void clear();
+
+        int findArchetype(ComponentMask mask);
+        int addArchetype(ComponentMask mask, vector<pair<int, int>> components);
+        Uint8* componentAt(Archetype *archetype, int row, int component_id);
+};
+
+EntityRegistry::EntityRegistry(){
+    records.reserve(4096);
+    free_records.reserve(4096);
+}
+
+EntityRegistry::~EntityRegistry(){
+    for (Archetype *archetype: archetypes){
+        delete archetype;
+    }
+}
+
+int EntityRegistry::findArchetype(ComponentMask mask){
+    for (int i = 0; i != int(archetypes.size()); i++){
+        if (archetypes[i] -> mask == mask){
+            return i;
+        }
+    }
+    return -1;
+}
+
+int EntityRegistry::addArchetype(ComponentMask mask, vector<pair<int, int>> components){
+    archetypes.push_back(new Archetype(mask, components));
+    return archetypes.size() - 1;
+}
+
+Uint8* EntityRegistry::componentAt(Archetype *archetype, int row, int component_id){
+    int chunk = row / archetype -> capacity;
+    int index = row % archetype -> capacity;
+    return archetype -> column(chunk, component_id) + index * archetype -> component_sizes[component_id];
+}
+
+template <typename... C>
+Entity EntityRegistry::create(C... components){
+    static_assert((is_trivially_copyable<C>::value && ...), "components have to be trivially copyable");
+    static_assert(((C::ID < ECS_MAX_COMPONENTS) && ...), "component id out of range");
+
+    // find archetype (only slow the first time a combination is used)
+    ComponentMask mask = componentMask<C...>();
+    int archetype_index = findArchetype(mask);
+    if (archetype_index == -1){
+        archetype_index = addArchetype(mask, {{C::ID, int(sizeof(C))}...});
+    }
+    Archetype *archetype = archetypes[archetype_index];
+
+    // record
+    Uint32 index;
+    if (!free_records.empty()){
+        index = free_records.back();
+        free_records.pop_back();
+    } else {
+        index = records.size();
+        records.push_back(EntityRecord());
+    }
+    Entity entity = {index, records[index].generation};
+
+    // new chunk if the last one is full (chunks are never freed, so this stops happening)
+    int row = archetype -> count;
+    if (row / archetype -> capacity == int(archetype -> chunks.size())){
+        archetype -> chunks.push_back(new EntityChunk());
+    }
+    archetype -> count += 1;
+
+    records[index].archetype = archetype_index;
+    records[index].row = row;
+
+    // copy components in
+    int chunk = row / archetype -> capacity;
+    archetype -> entities(chunk)[row % archetype -> capacity] = entity;
+    ((*(C*)componentAt(archetype, row, C::ID) = components), ...);
+
+    entity_count += 1;
+    return entity;
+}
+
+void EntityRegistry::destroy(Entity entity){
+    if (!valid(entity)){
+        return;
+    }
+    EntityRecord &record = records[entity.index];
+    Archetype *archetype = archetypes[record.archetype];
+    int row = record.row;
+    int last = archetype -> count - 1;
+
+    // move the last entity into the hole
+    if (row != last){
+        for (int id: archetype -> component_ids){
+            memcpy(componentAt(archetype, row, id), componentAt(archetype, last, id), archetype -> component_sizes[id]);
+        }
+        Entity moved = archetype -> entities(last / archetype -> capacity)[last % archetype -> capacity];
+        archetype -> entities(row / archetype -> capacity)[row % archetype -> capacity] = moved;
+        records[moved.index].row = row;
+    }
+    archetype -> count -= 1;
+
+    // old handles stop being valid
+    record.generation += 1;
+    record.archetype = -1;
+    free_records.push_back(entity.index);
+    entity_count -= 1;
+}
+
+bool EntityRegistry::valid(Entity entity){
+    return entity.index < records.size() && records[entity.index].generation == entity.generation && records[entity.index].archetype != -1;
+}
+
+template <typename C>
+bool EntityRegistry::has(Entity entity){
+    return valid(entity) && (archetypes[records[entity.index].archetype] -> mask & componentMask<C>());
+}
+
+template <typename C>
+C* EntityRegistry::get(Entity entity){
+    if (!has<C>(entity)){
+        return NULL;
+    }
+    EntityRecord &record = records[entity.index];
+    return (C*)componentAt(archetypes[record.archetype], record.row, C::ID);
+}
+
+template <typename... C, typename F>
+void EntityRegistry::each(F function){
+    // function(Entity, C&...) for every entity that has all of C
+    ComponentMask query = componentMask<C...>();
+
+    // only entities that exist now are visited
+    int archetype_count = archetypes.size();
+    int stack_counts[ECS_STACK_ARCHETYPES];
+    vector<int> heap_counts;
+    int *start_counts = stack_counts;
+    if (archetype_count > ECS_STACK_ARCHETYPES){
+        heap_counts.resize(archetype_count);
+        start_counts = heap_counts.data();
+    }
+    for (int a = 0; a != archetype_count; a++){
+        start_counts[a] = archetypes[a] -> count;
+    }
+
+    for (int a = 0; a != archetype_count; a++){
+        Archetype *archetype = archetypes[a];
+        int start_count = start_counts[a];
+        if ((archetype -> mask & query) != query || !start_count){
+            continue;
+        }
+
+        // backwards, so destroying the current entity only moves already visited (or new) ones
+        for (int chunk = (start_count - 1) / archetype -> capacity; chunk >= 0; chunk--){
+            tuple<C*...> columns((C*)archetype -> column(chunk, C::ID)...);
+            Entity *entities = archetype -> entities(chunk);
+            int rows = min(archetype -> chunkCount(chunk), start_count - chunk * archetype -> capacity);
+            for (int i = rows - 1; i >= 0; i--){
+                function(entities[i], std::get<C*>(columns)[i]...);
+            }
+        }
+    }
+}
+
+template <typename... C>
+int EntityRegistry::count(){
+    ComponentMask query = componentMask<C...>();
+    int total = 0;
+    for (Archetype *archetype: archetypes){
+        if ((archetype -> mask & query) == query){
+            total += archetype -> count;
+        }
+    }
+    return total;
+}
+
+void EntityRegistry::clear(){
+    // keeps chunks around for reuse
+    for (int a = 0; a != int(archetypes.size()); a++){
+        Archetype *archetype = archetypes[a];
+        for (int chunk = 0; chunk * archetype -> capacity < archetype -> count; chunk++){
+            Entity *entities = archetype -> entities(chunk);
+            for (int i = 0; i != archetype -> chunkCount(chunk); i++){
+                records[entities[i].index].generation += 1;
+                records[entities[i].index].archetype = -1;
+                free_records.push_back(entities[i].index);
+            }
+        }
+        archetype -> count = 0;
+    }
+    entity_count = 0;
+}
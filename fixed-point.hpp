@@ -0,0 +1,245 @@
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "functions.hpp"
+
+using namespace std;
+
+#pragma once
+
+// gameplay numbers (positions, velocities, sizes, bounds, enemy movement / aiming) are Scalars. normally
+// that's a float. built with -DFIXED_POINT_PHYSICS it's a 16.16 fixed point number instead, and the trig
+// they're used with comes from integer tables, so a game plays out bit for bit the same whatever the
+// compiler, optimization level or instruction set (floats can be kept at higher precision, contracted
+// into fmas, and sin / atan2 differ between c libraries).
+//
+// a Fixed is made from an int, float or double (rounded to the nearest 1 / 65536), and turned back with
+// int() (towards zero, like a float) or float(). sizes stay small (the screen is 600x700), so products are
+// done in 64 bits and nothing else checks for overflow. save states remember which one they were made with.
+
+const int FIXED_FRACTION_BITS = 16;
+const Sint32 FIXED_ONE = 1 << FIXED_FRACTION_BITS;
+
+// sin of 0 - 90 degrees, 16.16 (written out so no c library is involved)
+const Sint32 FIXED_SIN_TABLE[91] = {
+    0, 1144, 2287, 3430, 4572, 5712, 6850, 7987, 9121, 10252,
+    11380, 12505, 13626, 14742, 15855, 16962, 18064, 19161, 20252, 21336,
+    22415, 23486, 24550, 25607, 26656, 27697, 28729, 29753, 30767, 31772,
+    32768, 33754, 34729, 35693, 36647, 37590, 38521, 39441, 40348, 41243,
+    42126, 42995, 43852, 44695, 45525, 46341, 47143, 47930, 48703, 49461,
+    50203, 50931, 51643, 52339, 53020, 53684, 54332, 54963, 55578, 56175,
+    56756, 57319, 57865, 58393, 58903, 59396, 59870, 60326, 60764, 61183,
+    61584, 61966, 62328, 62672, 62997, 63303, 63589, 63856, 64104, 64332,
+    64540, 64729, 64898, 65048, 65177, 65287, 65376, 65446, 65496, 65526,
+    65536,
+};
+
+class Fixed{
+    public:
+        Sint32 raw = 0;
+
+        // methods
+        Fixed(){}
+        Fixed(int value);
+        Fixed(float value);
+        Fixed(double value);
+        static Fixed fromRaw(Sint32 raw_);
+
+        explicit operator int() const;
+        explicit operator float() const;
+
+        Fixed& operator+=(Fixed other);
+        Fixed& operator-=(Fixed other);
+        Fixed& operator*=(Fixed other);
+};
+
+Fixed::Fixed(int value){
+    raw = value * FIXED_ONE;
+}
+
+Fixed::Fixed(float value){
+    raw = Sint32(lround(double(value) * FIXED_ONE));
+}
+
+Fixed::Fixed(double value){
+    raw = Sint32(lround(value * FIXED_ONE));
+}
+
+Fixed Fixed::fromRaw(Sint32 raw_){
+    Fixed value;
+    value.raw = raw_;
+    return value;
+}
+
+Fixed::operator int() const{
+    return (raw >= 0) ? (raw >> FIXED_FRACTION_BITS) : -((-raw) >> FIXED_FRACTION_BITS);
+}
+
+Fixed::operator float() const{
+    return float(raw) / FIXED_ONE;
+}
+
+Fixed operator+(Fixed a, Fixed b){
+    return Fixed::fromRaw(a.raw + b.raw);
+}
+
+Fixed operator-(Fixed a, Fixed b){
+    return Fixed::fromRaw(a.raw - b.raw);
+}
+
+Fixed operator-(Fixed a){
+    return Fixed::fromRaw(-a.raw);
+}
+
+Fixed operator*(Fixed a, Fixed b){
+    return Fixed::fromRaw(Sint32((Sint64(a.raw) * b.raw) >> FIXED_FRACTION_BITS));
+}
+
+Fixed operator/(Fixed a, Fixed b){
+    return Fixed::fromRaw(Sint32(Sint64(a.raw) * FIXED_ONE / b.raw));
+}
+
+bool operator==(Fixed a, Fixed b){ return a.raw == b.raw; }
+bool operator!=(Fixed a, Fixed b){ return a.raw != b.raw; }
+bool operator<(Fixed a, Fixed b){ return a.raw < b.raw; }
+bool operator>(Fixed a, Fixed b){ return a.raw > b.raw; }
+bool operator<=(Fixed a, Fixed b){ return a.raw <= b.raw; }
+bool operator>=(Fixed a, Fixed b){ return a.raw >= b.raw; }
+
+Fixed& Fixed::operator+=(Fixed other){
+    raw += other.raw;
+    return *this;
+}
+
+Fixed& Fixed::operator-=(Fixed other){
+    raw -= other.raw;
+    return *this;
+}
+
+Fixed& Fixed::operator*=(Fixed other){
+    *this = *this * other;
+    return *this;
+}
+
+Fixed abs(Fixed value){
+    return Fixed::fromRaw(abs(value.raw));
+}
+
+Fixed fixedSin(int degrees){
+    degrees %= 360;
+    if (degrees < 0){
+        degrees += 360;
+    }
+    if (degrees <= 90){
+        return Fixed::fromRaw(FIXED_SIN_TABLE[degrees]);
+    } else if (degrees <= 180){
+        return Fixed::fromRaw(FIXED_SIN_TABLE[180 - degrees]);
+    } else if (degrees <= 270){
+        return Fixed::fromRaw(-FIXED_SIN_TABLE[degrees - 180]);
+    }
+    return Fixed::fromRaw(-FIXED_SIN_TABLE[360 - degrees]);
+}
+
+Fixed fixedCos(int degrees){
+    return fixedSin(degrees + 90);
+}
+
+int fixedAtan2Degrees(Fixed x, Fixed y){
+    // atan2(x, y) in whole degrees towards zero, like angle() in functions.hpp.
+    // for a = |x|, b = |y| the angle is at least k degrees when a cos k >= b sin k, so binary search 0 - 90
+    Sint64 a = abs(Sint64(x.raw));
+    Sint64 b = abs(Sint64(y.raw));
+    if (a == 0 && b == 0){
+        return 0;
+    }
+    auto atLeast = [&](int k){ return a * FIXED_SIN_TABLE[90 - k] >= b * FIXED_SIN_TABLE[k]; };
+    auto atMost = [&](int k){ return a * FIXED_SIN_TABLE[90 - k] <= b * FIXED_SIN_TABLE[k]; };
+
+    int degrees;
+    if (y.raw >= 0){
+        // largest k it's at least
+        int low = 0, high = 90;
+        while (low != high){
+            int middle = (low + high + 1) / 2;
+            if (atLeast(middle)){
+                low = middle;
+            } else {
+                high = middle - 1;
+            }
+        }
+        degrees = low;
+    } else {
+        // pointing down: 180 minus the angle from straight down, rounded up so the result rounds towards zero
+        int low = 0, high = 90;
+        while (low != high){
+            int middle = (low + high) / 2;
+            if (atMost(middle)){
+                high = middle;
+            } else {
+                low = middle + 1;
+            }
+        }
+        degrees = 180 - low;
+    }
+    return (x.raw < 0) ? -degrees : degrees;
+}
+
+Fixed fixedHypot(Fixed x, Fixed y){
+    // integer square root of x^2 + y^2 (in raw units squared, so the root is raw units)
+    Uint64 square = Uint64(Sint64(x.raw) * x.raw) + Uint64(Sint64(y.raw) * y.raw);
+    Uint64 root = 0;
+    Uint64 bit = Uint64(1) << 62;
+    while (bit > square){
+        bit >>= 2;
+    }
+    while (bit){
+        if (square >= root + bit){
+            square -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return Fixed::fromRaw(Sint32(root));
+}
+
+#ifdef FIXED_POINT_PHYSICS
+typedef Fixed Scalar;
+const bool PHYSICS_FIXED_POINT = true;
+#else
+typedef float Scalar;
+const bool PHYSICS_FIXED_POINT = false;
+#endif
+
+// the trig gameplay uses, for whole degrees (what every angle in the game is)
+
+Scalar sinDegrees(int degrees){
+    if (PHYSICS_FIXED_POINT){
+        return Scalar(fixedSin(degrees));
+    }
+    return Scalar(float(sin(degrees * M_PI / 180)));
+}
+
+Scalar cosDegrees(int degrees){
+    if (PHYSICS_FIXED_POINT){
+        return Scalar(fixedCos(degrees));
+    }
+    return Scalar(float(cos(degrees * M_PI / 180)));
+}
+
+int angleTo(Scalar x, Scalar y, Scalar target_x, Scalar target_y){
+    if (PHYSICS_FIXED_POINT){
+        return fixedAtan2Degrees(Fixed(target_x - x), Fixed(target_y - y));
+    }
+    return angle(float(x), float(y), float(target_x), float(target_y));
+}
+
+Scalar distance(Scalar x, Scalar y, Scalar target_x, Scalar target_y){
+    if (PHYSICS_FIXED_POINT){
+        return Scalar(fixedHypot(Fixed(target_x - x), Fixed(target_y - y)));
+    }
+    return Scalar(float(hypot(float(target_x - x), float(target_y - y))));
+}
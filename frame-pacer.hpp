@@ -0,0 +1,207 @@
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "game-classes.hpp"
+#include "render-backend.hpp"
+
+using namespace std;
+
+#pragma once
+
+// decides when frames start and how many game ticks each one runs, on the performance counter.
+//
+// PACE_SLEEP_SPIN: sleeps until just before the next frame's deadline, then spins the rest. the margin
+// left for spinning follows how much SDL_Delay has been oversleeping lately, so it ends up as a fraction
+// of a millisecond where the timer is good and more where it isn't. deadlines are absolute (the next one
+// is a period after the last one, not after waking up), so small errors don't add up.
+// PACE_VSYNC: present waits for the display, nothing here sleeps.
+// wait calls idle() between sleeps (at least once a millisecond) so the host can take in events.
+//
+// the game always ticks PACE_TICKS_PER_SECOND times a second, frames run however many ticks are due.
+// at the default target (120) that is always exactly one.
+
+const int PACE_SLEEP_SPIN = 0;
+const int PACE_VSYNC = 1;
+
+const float PACE_TICKS_PER_SECOND = 120;
+const int PACE_MAX_TICKS = 4; // per frame, past that the game slows down instead
+const int PACE_STATS_FRAMES = 120;
+
+class FramePacer{
+    public:
+        int mode;
+        float target_fps;
+
+        Uint64 frequency;
+        Uint64 frame_period;
+        Uint64 tick_period;
+        Uint64 display_period; // vsync
+
+        Uint64 deadline;
+        Uint64 last_frame_start;
+        Uint64 tick_accumulator = 0;
+
+        // sleep / spin
+        Uint64 spin_margin;
+        Uint64 max_oversleep = 0; // decays
+
+        // pacing error (how far frames started from when they should have), published every PACE_STATS_FRAMES
+        float average_error_us = 0;
+        float max_error_us = 0;
+        float jitter_us = 0; // standard deviation of frame to frame time
+        int late_frames = 0;
+
+        double error_sum = 0;
+        double error_max = 0;
+        double interval_sum = 0;
+        double interval_square_sum = 0;
+        int late_count = 0;
+        int stats_frames = 0;
+
+        // methods
+        FramePacer(float target_fps_, int mode_);
+        bool setVsync(SDL_Renderer *renderer, bool vsync, int refresh_rate);
+        int ticksDue();
+        template <typename F> void wait(F idle);
+        float frameBudget();
+        void renderDebug(RenderBackend &render, Camera &camera, FontRenderer &font_renderer, int x, int y);
+
+        Uint64 counterFromUs(double us);
+        float usFromCounter(double counter);
+        void recordFrame(Uint64 start, double error);
+};
+
+FramePacer::FramePacer(float target_fps_, int mode_ = PACE_SLEEP_SPIN){
+    mode = mode_;
+    target_fps = max(target_fps_, 1.0f);
+    frequency = SDL_GetPerformanceFrequency();
+    frame_period = frequency / target_fps;
+    tick_period = frequency / PACE_TICKS_PER_SECOND;
+    display_period = frame_period;
+    spin_margin = counterFromUs(2000);
+
+    last_frame_start = SDL_GetPerformanceCounter();
+    deadline = last_frame_start + frame_period;
+}
+
+Uint64 FramePacer::counterFromUs(double us){
+    return us * frequency / 1000000;
+}
+
+float FramePacer::usFromCounter(double counter){
+    return counter * 1000000 / frequency;
+}
+
+float FramePacer::frameBudget(){
+    // ms a frame can take
+    return 1000.0f / ((mode == PACE_VSYNC) ? float(frequency) / display_period : target_fps);
+}
+
+bool FramePacer::setVsync(SDL_Renderer *renderer, bool vsync, int refresh_rate){
+    if (SDL_RenderSetVSync(renderer, vsync) != 0){
+        cout << "Couldn't " << (vsync ? "enable" : "disable") << " vsync: " << SDL_GetError() << "\n";
+        mode = PACE_SLEEP_SPIN;
+        return false;
+    }
+    mode = vsync ? PACE_VSYNC : PACE_SLEEP_SPIN;
+    display_period = frequency / ((refresh_rate > 0) ? refresh_rate : 60);
+    return true;
+}
+
+int FramePacer::ticksDue(){
+    // called as a frame starts
+    if (mode == PACE_VSYNC){
+        // time since the last frame, capped so a long hitch doesn't turn into a burst of ticks
+        Uint64 now = SDL_GetPerformanceCounter();
+        tick_accumulator += min(now - last_frame_start, tick_period * PACE_MAX_TICKS);
+        recordFrame(now, double(now - last_frame_start) - display_period);
+    } else {
+        // frames are a fixed step apart, even when one wakes up a bit late
+        tick_accumulator += frame_period;
+    }
+
+    int ticks = min(int(tick_accumulator / tick_period), PACE_MAX_TICKS);
+    tick_accumulator = (ticks == PACE_MAX_TICKS) ? 0 : tick_accumulator - ticks * tick_period;
+    return ticks;
+}
+
+template <typename F>
+void FramePacer::wait(F idle){
+    // called once the frame is presented
+    if (mode == PACE_VSYNC){
+        return;
+    }
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (now < deadline){
+
+        // sleep most of the way, a millisecond at a time
+        idle();
+        now = SDL_GetPerformanceCounter();
+        while (now < deadline && deadline - now > spin_margin + frequency / 1000){
+            SDL_Delay(1);
+            Uint64 woke = SDL_GetPerformanceCounter();
+            Uint64 asked = frequency / 1000;
+            Uint64 oversleep = (woke - now > asked) ? woke - now - asked : 0;
+            max_oversleep = max(oversleep, max_oversleep - max_oversleep / 64);
+            spin_margin = clamp(max_oversleep + max_oversleep / 4 + counterFromUs(100), counterFromUs(200), counterFromUs(4000));
+
+            idle();
+            now = SDL_GetPerformanceCounter();
+        }
+
+        // spin the rest
+        while (now < deadline){
+            now = SDL_GetPerformanceCounter();
+        }
+    }
+
+    recordFrame(now, double(now) - double(deadline));
+
+    // next deadline, unless this frame was so late it's better to start over from now
+    if (now - deadline > frame_period){
+        deadline = now;
+    }
+    deadline += frame_period;
+}
+
+void FramePacer::recordFrame(Uint64 start, double error){
+    double interval = start - last_frame_start;
+    last_frame_start = start;
+
+    error_sum += fabs(error);
+    error_max = max(error_max, fabs(error));
+    interval_sum += interval;
+    interval_square_sum += interval * interval;
+    late_count += error > counterFromUs(500);
+    stats_frames += 1;
+
+    if (stats_frames == PACE_STATS_FRAMES){
+        double mean = interval_sum / stats_frames;
+        average_error_us = usFromCounter(error_sum / stats_frames);
+        max_error_us = usFromCounter(error_max);
+        jitter_us = usFromCounter(sqrt(max(interval_square_sum / stats_frames - mean * mean, 0.0)));
+        late_frames = late_count;
+
+        error_sum = 0;
+        error_max = 0;
+        interval_sum = 0;
+        interval_square_sum = 0;
+        late_count = 0;
+        stats_frames = 0;
+    }
+}
+
+void FramePacer::renderDebug(RenderBackend &render, Camera &camera, FontRenderer &font_renderer, int x, int y){
+    ostringstream mode_text;
+    mode_text << ((mode == PACE_VSYNC) ? "vsync" : "pacing") << " error " << int(average_error_us) << "us max " << int(max_error_us);
+    font_renderer.renderText(render, camera, mode_text.str(), x, y, 20, 255, 255, 0);
+
+    ostringstream jitter_text;
+    jitter_text << "jitter " << int(jitter_us) << "us late " << late_frames << " spin " << int(usFromCounter(spin_margin)) << "us";
+    font_renderer.renderText(render, camera, jitter_text.str(), x, y + 20, 20, 255, 255, 0);
+}
@@ -2,16 +2,24 @@
 #include <vector>
 #include <random>
 #include <unordered_map>
+#include <string>
+#include <sstream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
 #include "SDL2/include/SDL2/SDL.h"
 #include "SDL2/include/SDL2/SDL_image.h"
 
 #include "functions.hpp"
-#include "audio.hpp"
+#include "render-backend.hpp"
+#include "texture-cache.hpp"
+#include "sdf-font.hpp"
 
 using namespace std;
 
 #pragma once
 
+// one per world, offsets everything drawn while shaking and scales logical coordinates to the render size
 class Camera{
     public:
         // camera variables
@@ -23,6 +31,8 @@ class Camera{
         // shake variables
         int shake_time = 0;
         uniform_int_distribution<int> rand_coord;
+
+        vector<SDL_Rect> scaled_rects;
         
         // methods
         void update(default_random_engine& rand_generator);
@@ -31,14 +41,14 @@ class Camera{
         void scaleBy(float new_width, float new_height, float width, float height);
 
         void renderCopy(
-            SDL_Renderer *renderer, 
+            RenderBackend &render,
             SDL_Texture* texture, 
             const SDL_Rect* source, 
             const SDL_Rect* dest
         );
 
         void renderCopyEx(
-            SDL_Renderer* renderer,
+            RenderBackend &render,
             SDL_Texture* texture,
             const SDL_Rect* source,
             const SDL_Rect* dest,
@@ -46,6 +56,8 @@ class Camera{
             const SDL_Point *center,
             const SDL_RendererFlip flip
         );
+
+        void renderFillRects(RenderBackend &render, const vector<SDL_Rect> &rects, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
 };
 
 void Camera::update(default_random_engine& rand_generator){
@@ -77,17 +89,17 @@ void Camera::scaleBy(float new_width, float new_height, float width, float heigh
 }
 
 void Camera::renderCopy(
-        SDL_Renderer *renderer, 
+        RenderBackend &render,
         SDL_Texture* texture, 
         const SDL_Rect* source, 
         const SDL_Rect* dest
     ){
     SDL_Rect new_dest = {int((dest -> x + x) * wmult), int((dest -> y + y) * hmult), int(dest -> w * wmult), int(dest -> h * hmult)};
-    SDL_RenderCopy(renderer, texture, source, &new_dest);
+    render.copy(texture, source, &new_dest);
 }
 
 void Camera::renderCopyEx(
-    SDL_Renderer* renderer,
+    RenderBackend &render,
     SDL_Texture* texture,
     const SDL_Rect* source,
     const SDL_Rect* dest,
@@ -96,110 +108,16 @@ void Camera::renderCopyEx(
     const SDL_RendererFlip flip
     ){
         SDL_Rect new_dest = {int((dest -> x + x) * wmult), int((dest -> y + y) * hmult), int(dest -> w * wmult), int(dest -> h * hmult)};
-        SDL_RenderCopyEx(renderer, texture, source, &new_dest, angle, center, flip);
+        render.copyEx(texture, source, &new_dest, angle, center, flip);
     }
 
-Camera camera;
-
-class Particle{
-    public:
-        // game variables
-        float x;
-        float y;
-        float x_vel;
-        float y_vel;
-        float width;
-        float height;
-        int alpha;
-        int lose_alpha;
-        float gravity;
-
-        // sdl variables
-        SDL_Texture *texture;
-        SDL_Rect rect;
-
-        // methods
-        Particle(SDL_Texture *texture_, float x_, float y_, float x_vel_, float y_vel_, int alpha_, float width_, float height_, float gravity_, int lose_alpha_);
-        bool update();
-};
-
-Particle::Particle(SDL_Texture *texture_, float x_, float y_, float x_vel_, float y_vel_, int alpha_, float width_, float height_, float gravity_ = 0, int lose_alpha_ = 6){
-    // texture
-    texture = texture_;
-
-    // positions
-    x = x_;
-    y = y_;
-    x_vel = x_vel_;
-    y_vel = y_vel_;
-
-    // alpha
-    alpha = alpha_;
-    lose_alpha = lose_alpha_;
-
-    // gravity
-    gravity = gravity_;
-
-    // dimensions
-    width = width_;
-    height = height_;
-}
-
-bool Particle::update(){
-    // calculations
-    x += x_vel;
-    y += y_vel;
-    y_vel += gravity;
-    rect = {int(x), int(y), int(width), int(height)};
-    centerRect(rect);
-    alpha -= lose_alpha;
-    if (alpha < 1){
-        alpha = 1;
+void Camera::renderFillRects(RenderBackend &render, const vector<SDL_Rect> &rects, Uint8 r, Uint8 g, Uint8 b, Uint8 a){
+    scaled_rects.resize(rects.size());
+    for (size_t i = 0; i != rects.size(); i++){
+        const SDL_Rect &rect = rects[i];
+        scaled_rects[i] = {int((rect.x + x) * wmult), int((rect.y + y) * hmult), int(rect.w * wmult), int(rect.h * hmult)};
     }
-    
-    return (alpha != 1);
-}
-
-class Missile{
-    public:
-        // game variables
-        int x;
-        int y;
-        int speed;
-
-        // sdl variables
-        SDL_Texture *texture;
-        SDL_Rect rect;
-
-        // methods
-        Missile(SDL_Texture *texture_, int x_, int y_, int speed_);
-        bool update(SDL_Renderer *renderer);
-};
-
-Missile::Missile(SDL_Texture *texture_, int x_, int y_, int speed_){
-    // texture
-    texture = texture_;
-
-    // game variables
-    x = x_;
-    y = y_;
-    speed = speed_;
-
-    rect = {x, y, 40, 57};
-}
-
-bool Missile::update(SDL_Renderer *renderer){
-    // rect
-    rect = {x, y, 40, 57};
-    centerRect(rect);
-
-    // movement
-    y -= speed;
-
-    // show texture
-    camera.renderCopy(renderer, texture, NULL, &rect);
-
-    return (rect.y + rect.h > 0);
+    render.fillRects(scaled_rects.data(), scaled_rects.size(), r, g, b, a);
 }
 
 class Player{
@@ -218,25 +136,33 @@ class Player{
         int heart_shrink = -1;
 
         // sdl variables
-        SDL_Texture *texture;
-        SDL_Texture *hitbox_texture;
+        vector<string> texture_paths = {"assets/player/player.png", "assets/heart/heart.png"};
+        TextureRef texture;
+        TextureRef hitbox_texture;
         SDL_Rect display_rect = {0, 0, 60, 49};
         SDL_Rect rect = {0, 0, 20, 20};
 
         // methods
-        Player(SDL_Renderer *renderer);
-        void update(SDL_Renderer *renderer);
+        Player(){}
+        Player(TextureCache &textures);
+        void loadTextures(TextureCache &textures);
+        void update();
+        void render(RenderBackend &render, Camera &camera);
 };
 
-Player::Player(SDL_Renderer *renderer){
+Player::Player(TextureCache &textures){
+    loadTextures(textures);
+}
+
+void Player::loadTextures(TextureCache &textures){
     // texture
-    texture = loadTexture(renderer, "assets/player/player.png");
+    texture = textures.acquire(texture_paths[0]);
 
     // hitbox texture
-    hitbox_texture = loadTexture(renderer, "assets/heart/heart.png");
+    hitbox_texture = textures.acquire(texture_paths[1]);
 }
 
-void Player::update(SDL_Renderer *renderer){
+void Player::update(){
     // rect
     rect.x = x;
     rect.y = y + 10;
@@ -253,407 +179,211 @@ void Player::update(SDL_Renderer *renderer){
     heart_shrink *= -1 + 2 * !(heart_rad <= 0 || heart_rad >= 25);
     heart_rect.w = heart_rad;
     heart_rect.h = heart_rad;
+}
 
+void Player::render(RenderBackend &render, Camera &camera){
     // show texture
-    camera.renderCopy(renderer, texture, NULL, &display_rect);
+    camera.renderCopy(render, texture, NULL, &display_rect);
 
     // show hitbox texture
-    camera.renderCopy(renderer, hitbox_texture, NULL, &heart_rect);
+    camera.renderCopy(render, hitbox_texture, NULL, &heart_rect);
 }
 
-class EnemyAttack{
-    public:
-        // game variables
-        int alive_ticks = 0;
-        float x;
-        float y;
-        float xvel;
-        float yvel;
-        int width;
-        int height;
-        int damage;
-
-        // glow
-        float glow_radius;
-        float glow_max;
-        float glow_min;
-        int glow_direction = -1;
-
-        // const
-        int HIT_PLAYER = 1;
-        int OUT_OF_SCREEN = 2;
-
-        // sdl variables
-        int curr_frame = 0;
-        int next_frame_ticks = 0;
-        vector<SDL_Texture*> textures;
-        SDL_Rect rect;
-        
-        // methods
-        EnemyAttack(float x_, float y_, int width_, int height_, vector<SDL_Texture*> textures_, int damage_, float xvel_, float yvel_, int next_frame_ticks_);
-        int update(Player &player);
+// text from one truetype font (full printable ascii). the glyphs' distance field (see sdf-font.hpp) is
+// turned into white on transparent atlases (SDL's renderer has no shaders to do that per pixel), one for
+// each of a few fixed em sizes, a power of 2 apart. a string is drawn from the smallest one at least its
+// size, scaled down (less than 2x) by its quads with linear filtering, so it stays sharp at any size or
+// internal resolution. that's at most FONT_ATLAS_LEVELS textures, each made once, the first time it's needed.
+// every string is one batch of quads from one atlas.
+//
+// size is the old per-character png size: an em is 0.6 of it.
+
+const float FONT_EM_PER_SIZE = 0.6f;
+const int FONT_ATLAS_PADDING = 2;
+const int FONT_ATLAS_MIN_EM = 8; // pixels, level n is FONT_ATLAS_MIN_EM << n
+const int FONT_ATLAS_LEVELS = 4;
+
+struct FontAtlas{
+    SDL_Texture* texture = NULL;
+    int width = 0;
+    int height = 0;
+
+    // per glyph, in pixels: where it is in the texture, and where it goes from the pen / top of the line
+    vector<SDL_Rect> rects;
+    vector<SDL_Point> offsets;
 };
 
-EnemyAttack::EnemyAttack(float x_, float y_, int width_, int height_, vector<SDL_Texture*> textures_, int damage_, float xvel_, float yvel_, int next_frame_ticks_ = 1){
-    // game variables
-    x = x_;
-    y = y_;
-    width = width_;
-    height = height_;
-    damage = damage_;
-    xvel = xvel_;
-    yvel = yvel_;
-
-    // glow radius
-    glow_max = width * 2.5f;
-    glow_min = width * 2;
-    glow_radius = glow_max;
-
-    // texture
-    next_frame_ticks = next_frame_ticks_;
-    textures = textures_;
-
-}
-
-int EnemyAttack::update(Player &player){
-    alive_ticks += 1;
-
-    // rect
-    rect.x = x;
-    rect.y = y;
-    rect.w = width;
-    rect.h = height;
-    centerRect(rect);
-
-    // calculations
-    x += xvel;
-    y += yvel;
-
-    // frame
-    if (alive_ticks % next_frame_ticks == 0){
-        curr_frame = (curr_frame + 1) % textures.size();
-    }
-
-    // glow
-    glow_radius += 0.2f * glow_direction;
-    glow_direction *= -1 + 2 * !(glow_radius <= glow_min || glow_radius >= glow_max);
-
-    // intersection
-    if (SDL_HasIntersection(&player.rect, &rect)){
-        return HIT_PLAYER;
-    }
-
-    return !(x > -100 && x < 700 && y > -100 && y < 800) * OUT_OF_SCREEN;
-}
-
-class Enemy{
+class FontRenderer{
     public:
+        RenderBackend &render;
+        SDFFont font;
+        FontAtlas atlases[FONT_ATLAS_LEVELS];
 
-        // game variables
-        string type;
-        int health;
-        int alive_ticks;
-        float x;
-        float y;
-        float width;
-        float height;
-        float speed;
-
-        // attacks
-        float attack_rotation = 0;
-        float attack_rotation_vel;
-        float attack_xvel;
-        float attack_yvel;
-        float attack_xvel_mult;
-        float attack_yvel_mult;
-        int shot_num;
-        int shot_cooldown_curr;
-        int shot_cooldown;
-
-        // transition
-        int alpha = 0;
-        int transition_speed;
-
-        // movement
-        int next_move_ticks = 0;
-        int dist_to_target = 0;
-        int x_target;
-        int y_target;
-        float x_vel;
-        float y_vel;
-
-        // sdl variables
-        int curr_frame = 0;
-        int frame_delay_ticks;
-        vector<SDL_Texture*> textures;
-        SDL_Rect rect;
+        vector<SDL_Vertex> vertices;
+        vector<int> indices;
 
         // methods
-        Enemy(
-            string type_, 
-            vector<SDL_Texture*> textures_, 
-            float x_, 
-            float y_, 
-            float attack_rotation_vel_, 
-            float attack_xvel_mult_, 
-            float attack_yvel_mult_, 
-            float width_, 
-            float height_, 
-            float speed_, 
-            int frame_delay_ticks_, 
-            int health_, 
-            int shot_cooldown_,
-            int shot_num_,
-            int transition_speed_
-        );
-        bool update(default_random_engine rand_generator);
-        void shoot(vector<SDL_Texture*> attack_textures, vector<EnemyAttack> &attacks, int attack_width, int attack_height, int attack_damage, int attack_next_frame_ticks);
+        FontRenderer(RenderBackend &render_, string path);
+        ~FontRenderer();
+        void renderText(RenderBackend &render, Camera &camera, string text, int x, int y, int size, Uint8 r, Uint8 g, Uint8 b);
+        int renderTextCentered(RenderBackend &render, Camera &camera, string text, int x, int y, int size, Uint8 r, Uint8 g, Uint8 b);
+        float textWidth(const string &text, int size);
+        FontAtlas& atlas(int level);
+
+        FontRenderer(const FontRenderer&) = delete;
+        FontRenderer& operator=(const FontRenderer&) = delete;
 };
 
-Enemy::Enemy(
-            string type_, 
-            vector<SDL_Texture*> textures_, 
-            float x_, 
-            float y_, 
-            float attack_rotation_vel_, 
-            float attack_xvel_mult_, 
-            float attack_yvel_mult_, 
-            float width_, 
-            float height_, 
-            float speed_, 
-            int frame_delay_ticks_, 
-            int health_, 
-            int shot_cooldown_, 
-            int shot_num_,
-            int transition_speed_ = 5
-        ){
-    // texture
-    textures = textures_;
-    frame_delay_ticks = frame_delay_ticks_;
-
-    // game variables
-    type = type_;
-    x = x_;
-    y = y_;
-    width = width_;
-    height = height_;
-    speed = speed_;
-    health = health_;
-
-    // shooting
-    attack_rotation_vel = attack_rotation_vel_;
-    attack_xvel_mult = attack_xvel_mult_;
-    attack_yvel_mult = attack_yvel_mult_;
-    shot_cooldown = shot_cooldown_;
-    shot_cooldown_curr = shot_cooldown;
-    shot_num = shot_num_;
-
-    // rect
-    rect = {int(x), int(y), int(width), int(height)};
-
-    // transition
-    transition_speed = transition_speed_;
+FontRenderer::FontRenderer(RenderBackend &render_, string path) : render(render_){
+    // the distance field is only made once something is drawn (headless worlds never do)
+    font.load(path);
 }
 
-void Enemy::shoot(vector<SDL_Texture*> attack_textures, vector<EnemyAttack> &attacks, int attack_width, int attack_height, int attack_damage, int attack_next_frame_ticks){
-    for (int i = 0; i != shot_num; i++){
-        attack_rotation += attack_rotation_vel;
-        attack_xvel = sin(radians(attack_rotation)) * attack_xvel_mult;
-        attack_yvel = cos(radians(attack_rotation)) * attack_yvel_mult;
-        attacks.push_back(EnemyAttack(x, rect.y + rect.h, attack_width, attack_height, attack_textures, attack_damage, attack_xvel, attack_yvel, attack_next_frame_ticks));
+FontRenderer::~FontRenderer(){
+    for (FontAtlas &atlas : atlases){
+        if (atlas.texture != NULL){
+            render.destroyTexture(atlas.texture);
+        }
     }
 }
 
-bool Enemy::update(default_random_engine rand_generator){
-    alive_ticks += 1;
-
-    // rect
-    rect = {int(x), int(y), int(width), int(height)};
-    centerRect(rect);
-
-    // shooting
-    shot_cooldown_curr -= 1;
-
-    // random movement
-    if (!next_move_ticks){
-
-        // random target
-        uniform_int_distribution<int> x_coord_dist(0 + width / 2, 600 - width / 2);
-        uniform_int_distribution<int> y_coord_dist(0 + height / 2, 500 - height / 2); // don't go too close to the bottom
-        x_target = x_coord_dist(rand_generator);
-        y_target = y_coord_dist(rand_generator);
-
-        // get angles
-        int targ_angle = angle(x, y, x_target, y_target);
-
-        // get velocities
-        x_vel = sin(targ_angle * M_PI / 180);
-        y_vel = cos(targ_angle * M_PI / 180);
-
-        // distance
-        dist_to_target = hypot(x_target - x, y_target - y);
-
-        // set next move tick
-        next_move_ticks = 120;
+FontAtlas& FontRenderer::atlas(int level){
+    FontAtlas &atlas = atlases[level];
+    if (atlas.width != 0 || !font.loaded){
+        return atlas;
     }
-
-    // move
-    if (dist_to_target){
-        dist_to_target -= 1;
-        x += x_vel * speed * (alpha == 255); // move after transition
-        y += y_vel * speed * (alpha == 255);
-    } else {
-        next_move_ticks -= 1;
+    if (font.sdf.empty()){
+        font.buildSDF();
     }
 
-    // texture
-    if (alive_ticks % frame_delay_ticks == 0){
-        curr_frame = (curr_frame + 1) % textures.size();
+    // lay out glyph boxes on whole pixels, in rows
+    int em_pixels = FONT_ATLAS_MIN_EM << level;
+    float em = em_pixels;
+    int x = 0, y = 0, row_height = 0;
+    int atlas_width = max(1024, em_pixels * 4);
+    atlas.rects.resize(font.glyphs.size());
+    atlas.offsets.resize(font.glyphs.size());
+    for (size_t i = 0; i != font.glyphs.size(); i++){
+        FontGlyph &glyph = font.glyphs[i];
+        if (glyph.segments.empty()){
+            atlas.rects[i] = {0, 0, 0, 0};
+            continue;
+        }
+        int left = floor(glyph.x0 * em) - FONT_ATLAS_PADDING;
+        int top = floor((font.ascent - glyph.y1) * em) - FONT_ATLAS_PADDING;
+        int width = ceil(glyph.x1 * em) + FONT_ATLAS_PADDING - left;
+        int height = ceil((font.ascent - glyph.y0) * em) + FONT_ATLAS_PADDING - top;
+        if (x + width > atlas_width){
+            x = 0;
+            y += row_height;
+            row_height = 0;
+        }
+        atlas.rects[i] = {x, y, width, height};
+        atlas.offsets[i] = {left, top};
+        x += width;
+        row_height = max(row_height, height);
     }
 
-    // alpha
-    if (alpha != 255){
-        alpha += min(3, 255 - alpha);
+    atlas.width = atlas_width;
+    atlas.height = y + row_height;
+    atlas.texture = render.createStreamingTexture(atlas.width, atlas.height);
+    void *pixels;
+    int pitch;
+    if (atlas.texture == NULL || !render.lockTexture(atlas.texture, &pixels, &pitch)){
+        return atlas;
     }
 
-    return health > 0;
-}
-
-class Explosion{
-    public:
-        // game variables
-        int alive_ticks = 0;
-
-        // sdl variables
-        int curr_frame = 0;
-        int next_frame_ticks;
-        vector<SDL_Texture*> textures;
-        SDL_Rect rect;
-
-        // methods
-        Explosion(int x_, int y_, vector<SDL_Texture*> textures_, int width_, int height_, int next_frame_ticks_);
-        bool update(SDL_Renderer *renderer);
-};
-
-Explosion::Explosion(int x_, int y_, vector<SDL_Texture*> textures_, int width_ = 48, int height_ = 48, int next_frame_ticks_ = 5){
-    // rect variables
-    rect.x = x_;
-    rect.y = y_;
-    rect.w = width_;
-    rect.h = height_;
-    centerRect(rect);
-
-    // textures
-    next_frame_ticks = next_frame_ticks_;
-    textures = textures_;
-}
-
-bool Explosion::update(SDL_Renderer *renderer){
-    // update frames
-    alive_ticks += 1;
-    if (alive_ticks % next_frame_ticks == 0){
-        curr_frame += 1;
-        if (curr_frame == 5){
-            return false;
+    // coverage from the distance at each pixel center, about a pixel of antialiasing
+    for (int row = 0; row != atlas.height; row++){
+        memset((Uint8*)pixels + row * pitch, 0, atlas.width * 4);
+    }
+    for (size_t i = 0; i != font.glyphs.size(); i++){
+        SDL_Rect &rect = atlas.rects[i];
+        for (int j = 0; j < rect.h; j++){
+            Uint32 *row = (Uint32*)((Uint8*)pixels + (rect.y + j) * pitch) + rect.x;
+            float glyph_y = font.ascent - (atlas.offsets[i].y + j + 0.5f) / em;
+            for (int k = 0; k < rect.w; k++){
+                float glyph_x = (atlas.offsets[i].x + k + 0.5f) / em;
+                float coverage = clamp(font.distance(font.glyphs[i], glyph_x, glyph_y) * em + 0.5f, 0.0f, 1.0f);
+                row[k] = Uint32(coverage * 255 + 0.5f) << 24 | 0xFFFFFF;
+            }
         }
     }
+    render.unlockTexture(atlas.texture);
+    render.setBlendMode(atlas.texture, SDL_BLENDMODE_BLEND);
 
-    // show
-    camera.renderCopy(renderer, textures[curr_frame], NULL, &rect);
-
-    return true;
+    return atlas;
 }
 
-class FontRenderer{
-    public:
-        // unordered map for storing key value pairs.
-        unordered_map<string, SDL_Texture*> character_map;
-        unordered_map<string, vector<float>> character_size_ratio;
-
-        // methods
-        FontRenderer(SDL_Renderer *renderer, string path, string include);
-        void renderText(SDL_Renderer *renderer, string text, int x, int y, int size, Uint8 r, Uint8 g, Uint8 b);
-        int renderTextCentered(SDL_Renderer *renderer, string text, int x, int y, int size, Uint8 r, Uint8 g, Uint8 b);
-};
-
-FontRenderer::FontRenderer(SDL_Renderer *renderer, string path, string include = "abcdefghijklmnopqrstuvwxyz0123456789"){
-    for (auto c: include){
-        ostringstream string_stream;
-        string_stream << c;
-        string new_path = path + c + ".png";
-        SDL_Texture* font_texture = loadTexture(renderer, new_path.c_str());
-
-        string string_stream_str = string_stream.str();
-        character_map[string_stream_str] = font_texture;
-
-        // size ratio
-        int char_w, char_h;
-        SDL_QueryTexture(font_texture, NULL, NULL, &char_w, &char_h);
-        character_size_ratio[string_stream_str] = {char_w * 0.01f, char_h * 0.01f};
-
-    }
-}
-
-void FontRenderer::renderText(SDL_Renderer *renderer, string text, int x, int y, int size, Uint8 r, Uint8 g, Uint8 b){
-    SDL_Rect char_rect = {x, y, 0, 0};
-    for (auto c: text){
-
-        ostringstream string_stream;
-        string_stream << c;
-        string string_stream_str = string_stream.str();
-
-        if ((character_map.count(string_stream_str) != 0 && character_size_ratio.count(string_stream_str) != 0) || string_stream_str == " "){
-            
-            if (string_stream_str == " "){
-                char_rect.x += 20 * size / 60;
-
-            } else {
-                
-                char_rect.w = character_size_ratio[string_stream_str][0] * size;
-                char_rect.h = character_size_ratio[string_stream_str][1] * size;
-                
-                // set color
-                SDL_SetTextureColorMod(character_map[string_stream_str], r, g, b);
-
-                // render
-                camera.renderCopy(renderer, character_map[string_stream_str], NULL, &char_rect);
-                char_rect.x += char_rect.w;
-            }
-
+float FontRenderer::textWidth(const string &text, int size){
+    float width = 0;
+    for (char c : text){
+        FontGlyph *glyph = font.glyph(c);
+        if (glyph != NULL){
+            width += glyph -> advance * size * FONT_EM_PER_SIZE;
         }
     }
+    return width;
 }
 
-int FontRenderer::renderTextCentered(SDL_Renderer *renderer, string text, int x, int y, int size, Uint8 r, Uint8 g, Uint8 b){
-
-    int centered_x = x;
-    int total_width = 0;
-    float total_heights = 0;
-
-    for (auto c: text){
-
-        ostringstream string_stream;
-        string_stream << c;
-        string string_stream_str = string_stream.str();
-        
-        if ((character_map.count(string_stream_str) != 0 && character_size_ratio.count(string_stream_str) != 0) || string_stream_str == " "){
+void FontRenderer::renderText(RenderBackend &render, Camera &camera, string text, int x, int y, int size, Uint8 r, Uint8 g, Uint8 b){
+    // straight to output pixels, from the smallest atlas at least as big as the text
+    float em_pixels = size * FONT_EM_PER_SIZE * camera.hmult;
+    int level = 0;
+    while (level + 1 != FONT_ATLAS_LEVELS && (FONT_ATLAS_MIN_EM << level) < em_pixels){
+        level += 1;
+    }
+    FontAtlas &atlas = this -> atlas(level);
+    if (atlas.texture == NULL){
+        return;
+    }
 
-            if (string_stream_str == " "){
-                centered_x -= (20 * size / 60) / 2;
+    float scale = em_pixels / (FONT_ATLAS_MIN_EM << level);
+    float pen_x = (x + camera.x) * camera.wmult;
+    float top = (y + camera.y) * camera.hmult;
+    float advance_scale = size * FONT_EM_PER_SIZE * camera.wmult;
+    SDL_Color color = {r, g, b, 255};
+
+    vertices.clear();
+    indices.clear();
+    for (char c : text){
+        FontGlyph *glyph = font.glyph(c);
+        if (glyph == NULL){
+            continue;
+        }
 
-            } else {
-                centered_x -= character_size_ratio[string_stream_str][0] * size * 0.5f;
-                total_width += character_size_ratio[string_stream_str][0] * size;
-                total_heights += character_size_ratio[string_stream_str][1] * size * 0.5f;
-            }
+        int i = c - FONT_FIRST_CHAR;
+        SDL_Rect &rect = atlas.rects[i];
+        if (rect.w != 0){
+            float left = pen_x + atlas.offsets[i].x * scale;
+            float right = left + rect.w * scale;
+            float upper = top + atlas.offsets[i].y * scale;
+            float lower = upper + rect.h * scale;
+            float u0 = float(rect.x) / atlas.width;
+            float u1 = float(rect.x + rect.w) / atlas.width;
+            float v0 = float(rect.y) / atlas.height;
+            float v1 = float(rect.y + rect.h) / atlas.height;
+
+            int first = vertices.size();
+            vertices.push_back({{left, upper}, color, {u0, v0}});
+            vertices.push_back({{right, upper}, color, {u1, v0}});
+            vertices.push_back({{right, lower}, color, {u1, v1}});
+            vertices.push_back({{left, lower}, color, {u0, v1}});
+            indices.insert(indices.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
         }
+        pen_x += glyph -> advance * advance_scale;
     }
-    
-    int centered_y = y - total_heights / text.length();
 
-    renderText(renderer, text, centered_x, centered_y, size, r, g, b);
+    if (!indices.empty()){
+        render.geometry(atlas.texture, vertices.data(), vertices.size(), indices.data(), indices.size());
+    }
+}
 
-    return total_width;
+int FontRenderer::renderTextCentered(RenderBackend &render, Camera &camera, string text, int x, int y, int size, Uint8 r, Uint8 g, Uint8 b){
+    float width = textWidth(text, size);
+    float height = (font.ascent - font.descent) * size * FONT_EM_PER_SIZE;
+    renderText(render, camera, text, x - width / 2, y - height / 2, size, r, g, b);
+    return width;
 }
 
 class HealthBar{
@@ -663,17 +393,19 @@ class HealthBar{
         int bar_height;
 
         // sdl variables
-        SDL_Texture *texture;
+        string texture_path;
+        TextureRef texture;
         SDL_Rect rect;
 
         // methods
-        HealthBar(SDL_Renderer *renderer, string texture_path, int bar_width_, int bar_height_);
-        void update(SDL_Renderer *renderer, int health, int max_health);
+        HealthBar(string texture_path_, int bar_width_, int bar_height_);
+        void loadTexture(TextureCache &textures);
+        void update(RenderBackend &render, Camera &camera, int health, int max_health);
 };
 
-HealthBar::HealthBar(SDL_Renderer *renderer, string texture_path, int bar_width_, int bar_height_){
-    // texture
-    texture = loadTexture(renderer, texture_path.c_str());
+HealthBar::HealthBar(string texture_path_, int bar_width_, int bar_height_){
+    // texture (loaded when it's first needed)
+    texture_path = texture_path_;
 
     // rect
     bar_width = bar_width_;
@@ -681,7 +413,11 @@ HealthBar::HealthBar(SDL_Renderer *renderer, string texture_path, int bar_width_
     rect.h = bar_height;
 }
 
-void HealthBar::update(SDL_Renderer *renderer, int health, int max_health){
+void HealthBar::loadTexture(TextureCache &textures){
+    texture = textures.acquire(texture_path);
+}
+
+void HealthBar::update(RenderBackend &render, Camera &camera, int health, int max_health){
     // bar width multiplied by percentage of health
     rect.w = (float(health) / float(max_health)) * bar_width;
     rect.h = bar_height;
@@ -689,5 +425,5 @@ void HealthBar::update(SDL_Renderer *renderer, int health, int max_health){
     rect.y = 0;
     centerRect(rect);
 
-    camera.renderCopy(renderer, texture, NULL, &rect);
+    camera.renderCopy(render, texture, NULL, &rect);
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include <iostream>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "game-classes.hpp"
+#include "render-backend.hpp"
+
+using namespace std;
+
+#pragma once
+
+// the hud (health bar, hp text and the wave banner) drawn once into a texture and copied over the game every
+// frame. it's only drawn again when what it shows changes (health, wave) or the internal resolution does.
+//
+// the texture is made at full logical size, lower resolutions draw into the top left of it (like
+// DynamicResolution). the strip at the top is the health bar, the banner under it is copied wherever the
+// wave text is sliding past.
+//
+// text is antialiased onto a transparent texture, so each part starts out as its text's color at 0 alpha
+// (black for the strip, white for the banner). that way the edges keep the text's color and only fade out.
+
+const int HUD_WIDTH = 600;
+const int HUD_STRIP_HEIGHT = 60;
+const int HUD_BANNER_HEIGHT = 100;
+
+class HudLayer{
+    public:
+        SDL_Texture *texture = NULL;
+        Camera layer_camera; // draws into the texture at the scene's scale
+
+        // what the texture shows
+        bool drawn = false;
+        int health = 0;
+        int max_health = 0;
+        int wave = 0;
+
+        int redraws = 0;
+
+        // methods
+        HudLayer(RenderBackend &render);
+        template <typename F> void update(RenderBackend &render, Camera &camera, int health_, int max_health_, int wave_, F draw);
+        void renderStrip(RenderBackend &render, Camera &camera);
+        void renderBanner(RenderBackend &render, Camera &camera, int x, int y);
+        SDL_Rect source(int y, int height);
+};
+
+HudLayer::HudLayer(RenderBackend &render){
+    texture = render.createTargetTexture(HUD_WIDTH, HUD_STRIP_HEIGHT + HUD_BANNER_HEIGHT);
+    if (texture != NULL){
+        render.setBlendMode(texture, SDL_BLENDMODE_BLEND);
+    }
+}
+
+template <typename F>
+void HudLayer::update(RenderBackend &render, Camera &camera, int health_, int max_health_, int wave_, F draw){
+    // draw(layer_camera) draws the hud: strip from y 0, banner centered on (HUD_WIDTH / 2, HUD_STRIP_HEIGHT + HUD_BANNER_HEIGHT / 2)
+    bool rescaled = layer_camera.wmult != camera.wmult || layer_camera.hmult != camera.hmult;
+    if (texture == NULL || (drawn && !rescaled && health == health_ && max_health == max_health_ && wave == wave_)){
+        return;
+    }
+
+    drawn = true;
+    health = health_;
+    max_health = max_health_;
+    wave = wave_;
+    layer_camera.wmult = camera.wmult;
+    layer_camera.hmult = camera.hmult;
+    redraws += 1;
+
+    SDL_Texture *scene_target = render.setTarget(texture);
+    SDL_Rect strip = source(0, HUD_STRIP_HEIGHT);
+    SDL_Rect banner = source(HUD_STRIP_HEIGHT, HUD_BANNER_HEIGHT);
+    render.clearRect(&strip, 0, 0, 0, 0);
+    render.clearRect(&banner, 255, 255, 255, 0);
+    draw(layer_camera);
+    render.setTarget(scene_target);
+}
+
+SDL_Rect HudLayer::source(int y, int height){
+    // part of the texture, in the pixels it was drawn at
+    return {0, int(y * layer_camera.hmult), int(HUD_WIDTH * layer_camera.wmult), int(height * layer_camera.hmult)};
+}
+
+void HudLayer::renderStrip(RenderBackend &render, Camera &camera){
+    if (!drawn){
+        return;
+    }
+    SDL_Rect strip_source = source(0, HUD_STRIP_HEIGHT);
+    SDL_Rect strip_rect = {0, 0, HUD_WIDTH, HUD_STRIP_HEIGHT};
+    camera.renderCopy(render, texture, &strip_source, &strip_rect);
+}
+
+void HudLayer::renderBanner(RenderBackend &render, Camera &camera, int x, int y){
+    // centered on x, y
+    if (!drawn){
+        return;
+    }
+    SDL_Rect banner_source = source(HUD_STRIP_HEIGHT, HUD_BANNER_HEIGHT);
+    SDL_Rect banner_rect = {x - HUD_WIDTH / 2, y - HUD_BANNER_HEIGHT / 2, HUD_WIDTH, HUD_BANNER_HEIGHT};
+    camera.renderCopy(render, texture, &banner_source, &banner_rect);
+}
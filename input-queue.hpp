@@ -0,0 +1,107 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "game-classes.hpp"
+#include "render-backend.hpp"
+
+using namespace std;
+
+#pragma once
+
+// events are taken from SDL whenever the host has a moment (pump), stamped with the performance counter
+// (SDL's own timestamps are whole ms), and handled just before the ticks that use them.
+//
+// input latency is measured from the oldest key press / release a tick used to the end of the
+// SDL_RenderPresent that shows that tick. the host calls simulated() after a tick has run and presented()
+// after present.
+
+const int INPUT_STATS_SAMPLES = 20;
+
+struct QueuedEvent{
+    SDL_Event event;
+    Uint64 time;
+};
+
+class InputQueue{
+    public:
+        vector<QueuedEvent> events;
+
+        // oldest key event taken but not simulated yet / simulated but not presented yet (0 = none)
+        Uint64 unsimulated_since = 0;
+        Uint64 unpresented_since = 0;
+
+        // latency, published every INPUT_STATS_SAMPLES key presses
+        float last_latency_us = 0;
+        float average_latency_us = 0;
+        float max_latency_us = 0;
+
+        double latency_sum = 0;
+        double latency_max = 0;
+        int latency_count = 0;
+
+        // methods
+        void pump();
+        void take();
+        void simulated();
+        void presented();
+        void renderDebug(RenderBackend &render, Camera &camera, FontRenderer &font_renderer, int x, int y);
+};
+
+void InputQueue::pump(){
+    Uint64 now = SDL_GetPerformanceCounter();
+    SDL_Event event;
+    while (SDL_PollEvent(&event) != 0){
+        events.push_back({event, now});
+    }
+}
+
+void InputQueue::take(){
+    // the host has handled events, start timing the first key event among them
+    if (unsimulated_since == 0){
+        for (QueuedEvent &queued : events){
+            if ((queued.event.type == SDL_KEYDOWN || queued.event.type == SDL_KEYUP) && !queued.event.key.repeat){
+                unsimulated_since = queued.time;
+                break;
+            }
+        }
+    }
+    events.clear();
+}
+
+void InputQueue::simulated(){
+    if (unsimulated_since != 0 && unpresented_since == 0){
+        unpresented_since = unsimulated_since;
+    }
+    unsimulated_since = 0;
+}
+
+void InputQueue::presented(){
+    if (unpresented_since == 0){
+        return;
+    }
+
+    last_latency_us = (SDL_GetPerformanceCounter() - unpresented_since) * 1000000.0 / SDL_GetPerformanceFrequency();
+    unpresented_since = 0;
+
+    latency_sum += last_latency_us;
+    latency_max = max(latency_max, double(last_latency_us));
+    latency_count += 1;
+    if (latency_count == INPUT_STATS_SAMPLES){
+        average_latency_us = latency_sum / latency_count;
+        max_latency_us = latency_max;
+        latency_sum = 0;
+        latency_max = 0;
+        latency_count = 0;
+    }
+}
+
+void InputQueue::renderDebug(RenderBackend &render, Camera &camera, FontRenderer &font_renderer, int x, int y){
+    // average / max only fill in after enough key presses, the last one is there straight away
+    ostringstream latency_text;
+    latency_text << "input " << int(last_latency_us) << "us avg " << int(average_latency_us) << " max " << int(max_latency_us);
+    font_renderer.renderText(render, camera, latency_text.str(), x, y, 20, 255, 255, 0);
+}
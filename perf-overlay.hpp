@@ -0,0 +1,168 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "game-classes.hpp"
+#include "render-backend.hpp"
+#include "ecs.hpp"
+#include "components.hpp"
+
+using namespace std;
+
+#pragma once
+
+// frame stats drawn over the game (f2 toggles it): fps, a frame time graph, the slowest phase of the frame,
+// entity counts, draw calls and texture memory. the text is only rebuilt a few times a second and the graph
+// is one fillRects call, so having it open barely changes what it measures.
+//
+// the host marks the end of each phase of a frame (endPhase) and hands over the frame time (endFrame).
+
+const int PERF_HISTORY = 120; // frames in the graph
+const int PERF_REFRESH_FRAMES = 15; // frames between text rebuilds
+const int PERF_GRAPH_HEIGHT = 50;
+
+class PerfOverlay{
+    public:
+        bool show = false;
+        float frame_budget; // ms, half the graph height
+
+        // phases, timed from one endPhase to the next
+        vector<const char*> phase_names;
+        vector<float> phase_total_ms; // since the text was rebuilt
+        Uint64 phase_start = 0;
+
+        // frame times for the graph (ring)
+        vector<float> frame_ms;
+        int next_frame = 0;
+
+        // cached
+        vector<string> lines;
+        vector<SDL_Rect> bars;
+        int frames_since_refresh = 0;
+        Uint64 refresh_start = 0;
+
+        // methods
+        PerfOverlay(float frame_budget_);
+        void beginFrame();
+        void endPhase(const char *name);
+        void endFrame(float frame_time, EntityRegistry &entities, RenderBackend &render);
+        void render(RenderBackend &render, Camera &camera, FontRenderer &font_renderer, int x, int y);
+
+        void refreshText(EntityRegistry &entities, RenderBackend &render);
+};
+
+PerfOverlay::PerfOverlay(float frame_budget_){
+    frame_budget = frame_budget_;
+    frame_ms.resize(PERF_HISTORY, 0);
+    bars.resize(PERF_HISTORY);
+    refresh_start = SDL_GetPerformanceCounter();
+}
+
+void PerfOverlay::beginFrame(){
+    phase_start = SDL_GetPerformanceCounter();
+}
+
+void PerfOverlay::endPhase(const char *name){
+    Uint64 now = SDL_GetPerformanceCounter();
+    float ms = (now - phase_start) * 1000.0f / SDL_GetPerformanceFrequency();
+    phase_start = now;
+
+    for (size_t i = 0; i != phase_names.size(); i++){
+        if (strcmp(phase_names[i], name) == 0){
+            phase_total_ms[i] += ms;
+            return;
+        }
+    }
+    phase_names.push_back(name);
+    phase_total_ms.push_back(ms);
+}
+
+void PerfOverlay::endFrame(float frame_time, EntityRegistry &entities, RenderBackend &render){
+    frame_ms[next_frame] = frame_time;
+    next_frame = (next_frame + 1) % PERF_HISTORY;
+
+    frames_since_refresh += 1;
+    if (frames_since_refresh >= PERF_REFRESH_FRAMES){
+        if (show){
+            refreshText(entities, render);
+        }
+        frames_since_refresh = 0;
+        refresh_start = SDL_GetPerformanceCounter();
+        fill(phase_total_ms.begin(), phase_total_ms.end(), 0);
+    }
+}
+
+void PerfOverlay::refreshText(EntityRegistry &entities, RenderBackend &render){
+    float seconds = float(SDL_GetPerformanceCounter() - refresh_start) / SDL_GetPerformanceFrequency();
+
+    float average_ms = 0;
+    float max_ms = 0;
+    for (float ms : frame_ms){
+        average_ms += ms;
+        max_ms = max(max_ms, ms);
+    }
+    average_ms /= PERF_HISTORY;
+
+    int slowest = 0;
+    for (size_t i = 0; i != phase_total_ms.size(); i++){
+        if (phase_total_ms[i] > phase_total_ms[slowest]){
+            slowest = i;
+        }
+    }
+
+    lines.clear();
+
+    ostringstream fps_text;
+    fps_text << "fps " << int(frames_since_refresh / max(seconds, 0.001f) + 0.5f);
+    lines.push_back(fps_text.str());
+
+    ostringstream frame_text;
+    frame_text << "frame " << int(average_ms * 1000) << "us max " << int(max_ms * 1000) << "us";
+    lines.push_back(frame_text.str());
+
+    if (!phase_names.empty()){
+        ostringstream phase_text;
+        phase_text << "slowest " << phase_names[slowest] << " " << int(phase_total_ms[slowest] * 1000 / frames_since_refresh) << "us";
+        lines.push_back(phase_text.str());
+    }
+
+    ostringstream enemies_text;
+    enemies_text << "enemies " << entities.count<EnemyInfo>() << " attacks " << entities.count<EnemyShot>();
+    lines.push_back(enemies_text.str());
+
+    ostringstream particles_text;
+    particles_text << "particles " << entities.count<Fade>() << " missiles " << entities.count<PlayerShot>();
+    lines.push_back(particles_text.str());
+
+    ostringstream draws_text;
+    draws_text << "explosions " << entities.count<OneShot>() << " draws " << render.draw_calls;
+    lines.push_back(draws_text.str());
+
+    ostringstream textures_text;
+    textures_text << "textures " << render.texture_count << " " << render.texture_bytes / 1024 << "kb";
+    lines.push_back(textures_text.str());
+}
+
+void PerfOverlay::render(RenderBackend &render, Camera &camera, FontRenderer &font_renderer, int x, int y){
+    if (!show){
+        return;
+    }
+
+    // graph, oldest on the left, the budget is half way up
+    for (int i = 0; i != PERF_HISTORY; i++){
+        float ms = frame_ms[(next_frame + i) % PERF_HISTORY];
+        int height = min(ms / (frame_budget * 2), 1.0f) * PERF_GRAPH_HEIGHT;
+        bars[i] = {x + i * 2, y + PERF_GRAPH_HEIGHT - height, 2, height};
+    }
+    camera.renderFillRects(render, bars, 0, 255, 0, 180);
+
+    y += PERF_GRAPH_HEIGHT + 5;
+    for (string &line : lines){
+        font_renderer.renderText(render, camera, line, x, y, 20, 255, 255, 0);
+        y += 20;
+    }
+}
@@ -0,0 +1,145 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "game-classes.hpp"
+
+using namespace std;
+
+#pragma once
+
+// watches a rolling average of frame times and turns effects down one step at a time
+// when frames get too slow, and back up when there is time to spare.
+// every tunable has its own band (fractions of the frame budget) so they don't all flip at once.
+
+class QualityTunable{
+    public:
+        string name;
+        int level;
+        int max_level;
+
+        // hysteresis band, as a fraction of the frame budget
+        float lower_above;
+        float raise_below;
+
+        // methods
+        QualityTunable(string name_, int max_level_, float lower_above_, float raise_below_);
+};
+
+QualityTunable::QualityTunable(string name_, int max_level_, float lower_above_, float raise_below_){
+    name = name_;
+    max_level = max_level_;
+    level = max_level;
+    lower_above = lower_above_;
+    raise_below = raise_below_;
+}
+
+// tunables
+const int QUALITY_PARTICLES = 0; // thruster particles per tick / death trail rate
+const int QUALITY_GLOW = 1; // 2 = everything glows, 1 = only bullets, 0 = nothing
+const int QUALITY_EXPLOSIONS = 2; // 2 = every bullet hit, 1 = every other hit, 0 = none
+const int QUALITY_SHAKE = 3; // 2 = all shakes, 1 = no small hit shakes, 0 = none
+
+const int QUALITY_WINDOW = 60; // frames in rolling average
+
+class QualityGovernor{
+    public:
+        // frame time tracking
+        float frame_budget;
+        float frame_times[QUALITY_WINDOW] = {};
+        float frame_time_sum = 0;
+        int frame_index = 0;
+        int frame_count = 0;
+        float load = 0; // rolling average frame time / budget
+
+        // only one step every so often, so the average can react
+        int step_delay = 30;
+        int next_step_ticks = 0;
+
+        // debug readout
+        bool show_debug = false;
+        int explosion_counter = 0;
+
+        vector<QualityTunable> tunables = {
+            QualityTunable("particles", 3, 0.85f, 0.55f),
+            QualityTunable("glow", 2, 0.9f, 0.6f),
+            QualityTunable("explosions", 2, 0.95f, 0.65f),
+            QualityTunable("shake", 2, 1.0f, 0.7f),
+        };
+
+        // methods
+        QualityGovernor(float frame_budget_);
+        void update(float frame_time);
+        int level(int tunable);
+        bool spawnExplosion();
+        void renderDebug(RenderBackend &render, Camera &camera, FontRenderer &font_renderer, int x, int y);
+};
+
+QualityGovernor::QualityGovernor(float frame_budget_){
+    frame_budget = frame_budget_;
+}
+
+void QualityGovernor::update(float frame_time){
+    // rolling average
+    frame_time_sum += frame_time - frame_times[frame_index];
+    frame_times[frame_index] = frame_time;
+    frame_index = (frame_index + 1) % QUALITY_WINDOW;
+    frame_count = min(frame_count + 1, QUALITY_WINDOW);
+    load = frame_time_sum / frame_count / frame_budget;
+
+    if (next_step_ticks){
+        next_step_ticks -= 1;
+        return;
+    }
+
+    // lower the first tunable over its band (cheapest to lose first)
+    for (QualityTunable &tunable: tunables){
+        if (load > tunable.lower_above && tunable.level > 0){
+            tunable.level -= 1;
+            next_step_ticks = step_delay;
+            return;
+        }
+    }
+
+    // raise the last lowered one if it is under its band (reverse order)
+    for (int i = tunables.size() - 1; i >= 0; i--){
+        QualityTunable &tunable = tunables[i];
+        if (tunable.level < tunable.max_level){
+            if (load < tunable.raise_below){
+                tunable.level += 1;
+                next_step_ticks = step_delay;
+            }
+            return;
+        }
+    }
+}
+
+int QualityGovernor::level(int tunable){
+    return tunables[tunable].level;
+}
+
+bool QualityGovernor::spawnExplosion(){
+    // thin out hit explosions depending on level
+    explosion_counter += 1;
+    int every = (level(QUALITY_EXPLOSIONS) == 2) ? 1 : 2;
+    return level(QUALITY_EXPLOSIONS) && explosion_counter % every == 0;
+}
+
+void QualityGovernor::renderDebug(RenderBackend &render, Camera &camera, FontRenderer &font_renderer, int x, int y){
+    if (!show_debug){
+        return;
+    }
+
+    ostringstream load_text;
+    load_text << "load " << int(load * 100);
+    font_renderer.renderText(render, camera, load_text.str(), x, y, 20, 255, 255, 0);
+
+    for (QualityTunable &tunable: tunables){
+        y += 20;
+        ostringstream tunable_text;
+        tunable_text << tunable.name << " " << tunable.level << " of " << tunable.max_level;
+        font_renderer.renderText(render, camera, tunable_text.str(), x, y, 20, 255, 255, 0);
+    }
+}
@@ -0,0 +1,234 @@
+#include <iostream>
+#include "SDL2/include/SDL2/SDL.h"
+#include "SDL2/include/SDL2/SDL_image.h"
+
+#include "functions.hpp"
+
+using namespace std;
+
+#pragma once
+
+// everything a world draws goes through one of these, so a world doesn't need to know about the window.
+// SDLRender draws with an SDL renderer, NullRender draws nothing and loads no textures (headless worlds).
+// SDL renderers aren't thread safe, so only one thread should use an SDLRender.
+// draws and texture switches are counted until whoever reads them (telemetry) resets them. textures alive
+// (and their size, 4 bytes a pixel) are kept count of all the time.
+
+class RenderBackend{
+    public:
+        int draw_calls = 0;
+        int texture_switches = 0;
+        SDL_Texture *last_texture = NULL;
+        int texture_count = 0;
+        Uint64 texture_bytes = 0;
+
+        virtual ~RenderBackend(){}
+
+        void countDraw(SDL_Texture *texture);
+        void resetCounters();
+        void countTexture(SDL_Texture *texture, int sign);
+
+        virtual SDL_Texture* loadTexture(const char *path) = 0;
+        virtual SDL_Texture* textureFromSurface(SDL_Surface *surface) = 0;
+        virtual SDL_Texture* createStreamingTexture(int width, int height) = 0;
+        virtual SDL_Texture* createTargetTexture(int width, int height) = 0;
+        virtual SDL_Texture* setTarget(SDL_Texture *texture) = 0; // returns the one it replaced
+        virtual bool lockTexture(SDL_Texture *texture, void **pixels, int *pitch) = 0;
+        virtual void unlockTexture(SDL_Texture *texture) = 0;
+        virtual void destroyTexture(SDL_Texture *texture) = 0;
+        virtual void queryTexture(SDL_Texture *texture, int *width, int *height) = 0;
+        virtual void setBlendMode(SDL_Texture *texture, SDL_BlendMode blend_mode) = 0;
+        virtual void setAlpha(SDL_Texture *texture, Uint8 alpha) = 0;
+        virtual void setColor(SDL_Texture *texture, Uint8 r, Uint8 g, Uint8 b) = 0;
+
+        virtual void clear() = 0;
+        virtual void clearRect(const SDL_Rect *rect, Uint8 r, Uint8 g, Uint8 b, Uint8 a) = 0; // sets pixels as they are (no blending), NULL for all of them
+        virtual void copy(SDL_Texture *texture, const SDL_Rect *source, const SDL_Rect *dest) = 0;
+        virtual void copyEx(SDL_Texture *texture, const SDL_Rect *source, const SDL_Rect *dest, double angle, const SDL_Point *center, SDL_RendererFlip flip) = 0;
+        virtual void fillRects(const SDL_Rect *rects, int count, Uint8 r, Uint8 g, Uint8 b, Uint8 a) = 0;
+        virtual void geometry(SDL_Texture *texture, const SDL_Vertex *vertices, int vertex_count, const int *indices, int index_count) = 0;
+};
+
+void RenderBackend::countDraw(SDL_Texture *texture){
+    draw_calls += 1;
+    if (texture != last_texture){
+        texture_switches += 1;
+        last_texture = texture;
+    }
+}
+
+void RenderBackend::resetCounters(){
+    draw_calls = 0;
+    texture_switches = 0;
+}
+
+void RenderBackend::countTexture(SDL_Texture *texture, int sign){
+    if (texture == NULL){
+        return;
+    }
+    int width, height;
+    queryTexture(texture, &width, &height);
+    texture_count += sign;
+    texture_bytes += sign * Sint64(width) * height * 4;
+}
+
+class SDLRender : public RenderBackend{
+    public:
+        SDL_Renderer *renderer;
+
+        // methods
+        SDLRender(SDL_Renderer *renderer_);
+        SDL_Texture* loadTexture(const char *path);
+        SDL_Texture* textureFromSurface(SDL_Surface *surface);
+        SDL_Texture* createStreamingTexture(int width, int height);
+        SDL_Texture* createTargetTexture(int width, int height);
+        SDL_Texture* setTarget(SDL_Texture *texture);
+        bool lockTexture(SDL_Texture *texture, void **pixels, int *pitch);
+        void unlockTexture(SDL_Texture *texture);
+        void destroyTexture(SDL_Texture *texture);
+        void queryTexture(SDL_Texture *texture, int *width, int *height);
+        void setBlendMode(SDL_Texture *texture, SDL_BlendMode blend_mode);
+        void setAlpha(SDL_Texture *texture, Uint8 alpha);
+        void setColor(SDL_Texture *texture, Uint8 r, Uint8 g, Uint8 b);
+        void clear();
+        void clearRect(const SDL_Rect *rect, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+        void copy(SDL_Texture *texture, const SDL_Rect *source, const SDL_Rect *dest);
+        void copyEx(SDL_Texture *texture, const SDL_Rect *source, const SDL_Rect *dest, double angle, const SDL_Point *center, SDL_RendererFlip flip);
+        void fillRects(const SDL_Rect *rects, int count, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+        void geometry(SDL_Texture *texture, const SDL_Vertex *vertices, int vertex_count, const int *indices, int index_count);
+};
+
+SDLRender::SDLRender(SDL_Renderer *renderer_){
+    renderer = renderer_;
+}
+
+SDL_Texture* SDLRender::loadTexture(const char *path){
+    SDL_Texture *texture = ::loadTexture(renderer, path);
+    countTexture(texture, 1);
+    return texture;
+}
+
+SDL_Texture* SDLRender::textureFromSurface(SDL_Surface *surface){
+    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
+    countTexture(texture, 1);
+    return texture;
+}
+
+SDL_Texture* SDLRender::createStreamingTexture(int width, int height){
+    SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+    SDL_SetTextureScaleMode(texture, SDL_ScaleModeLinear);
+    countTexture(texture, 1);
+    return texture;
+}
+
+SDL_Texture* SDLRender::createTargetTexture(int width, int height){
+    SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    SDL_SetTextureScaleMode(texture, SDL_ScaleModeLinear);
+    countTexture(texture, 1);
+    return texture;
+}
+
+SDL_Texture* SDLRender::setTarget(SDL_Texture *texture){
+    SDL_Texture *previous = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, texture);
+    return previous;
+}
+
+bool SDLRender::lockTexture(SDL_Texture *texture, void **pixels, int *pitch){
+    return SDL_LockTexture(texture, NULL, pixels, pitch) == 0;
+}
+
+void SDLRender::unlockTexture(SDL_Texture *texture){
+    SDL_UnlockTexture(texture);
+}
+
+void SDLRender::destroyTexture(SDL_Texture *texture){
+    if (texture != NULL){
+        countTexture(texture, -1);
+        SDL_DestroyTexture(texture);
+    }
+}
+
+void SDLRender::queryTexture(SDL_Texture *texture, int *width, int *height){
+    if (SDL_QueryTexture(texture, NULL, NULL, width, height) != 0){
+        *width = 0;
+        *height = 0;
+    }
+}
+
+void SDLRender::setBlendMode(SDL_Texture *texture, SDL_BlendMode blend_mode){
+    SDL_SetTextureBlendMode(texture, blend_mode);
+}
+
+void SDLRender::setAlpha(SDL_Texture *texture, Uint8 alpha){
+    SDL_SetTextureAlphaMod(texture, alpha);
+}
+
+void SDLRender::setColor(SDL_Texture *texture, Uint8 r, Uint8 g, Uint8 b){
+    SDL_SetTextureColorMod(texture, r, g, b);
+}
+
+void SDLRender::clear(){
+    SDL_RenderClear(renderer);
+}
+
+void SDLRender::clearRect(const SDL_Rect *rect, Uint8 r, Uint8 g, Uint8 b, Uint8 a){
+    // the draw color and blend mode are put back
+    Uint8 old_r, old_g, old_b, old_a;
+    SDL_BlendMode old_blend_mode;
+    SDL_GetRenderDrawColor(renderer, &old_r, &old_g, &old_b, &old_a);
+    SDL_GetRenderDrawBlendMode(renderer, &old_blend_mode);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, r, g, b, a);
+    SDL_RenderFillRect(renderer, rect);
+    SDL_SetRenderDrawColor(renderer, old_r, old_g, old_b, old_a);
+    SDL_SetRenderDrawBlendMode(renderer, old_blend_mode);
+}
+
+void SDLRender::copy(SDL_Texture *texture, const SDL_Rect *source, const SDL_Rect *dest){
+    countDraw(texture);
+    SDL_RenderCopy(renderer, texture, source, dest);
+}
+
+void SDLRender::copyEx(SDL_Texture *texture, const SDL_Rect *source, const SDL_Rect *dest, double angle, const SDL_Point *center, SDL_RendererFlip flip){
+    countDraw(texture);
+    SDL_RenderCopyEx(renderer, texture, source, dest, angle, center, flip);
+}
+
+void SDLRender::fillRects(const SDL_Rect *rects, int count, Uint8 r, Uint8 g, Uint8 b, Uint8 a){
+    // one call for all of them, the draw color is put back (clearing uses it)
+    Uint8 old_r, old_g, old_b, old_a;
+    SDL_GetRenderDrawColor(renderer, &old_r, &old_g, &old_b, &old_a);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, r, g, b, a);
+    SDL_RenderFillRects(renderer, rects, count);
+    SDL_SetRenderDrawColor(renderer, old_r, old_g, old_b, old_a);
+    draw_calls += 1;
+}
+
+void SDLRender::geometry(SDL_Texture *texture, const SDL_Vertex *vertices, int vertex_count, const int *indices, int index_count){
+    countDraw(texture);
+    SDL_RenderGeometry(renderer, texture, vertices, vertex_count, indices, index_count);
+}
+
+class NullRender : public RenderBackend{
+    public:
+        SDL_Texture* loadTexture(const char *path){ return NULL; }
+        SDL_Texture* textureFromSurface(SDL_Surface *surface){ return NULL; }
+        SDL_Texture* createStreamingTexture(int width, int height){ return NULL; }
+        SDL_Texture* createTargetTexture(int width, int height){ return NULL; }
+        SDL_Texture* setTarget(SDL_Texture *texture){ return NULL; }
+        bool lockTexture(SDL_Texture *texture, void **pixels, int *pitch){ return false; }
+        void unlockTexture(SDL_Texture *texture){}
+        void destroyTexture(SDL_Texture *texture){}
+        void queryTexture(SDL_Texture *texture, int *width, int *height){ *width = 0; *height = 0; }
+        void setBlendMode(SDL_Texture *texture, SDL_BlendMode blend_mode){}
+        void setAlpha(SDL_Texture *texture, Uint8 alpha){}
+        void setColor(SDL_Texture *texture, Uint8 r, Uint8 g, Uint8 b){}
+        void clear(){}
+        void clearRect(const SDL_Rect *rect, Uint8 r, Uint8 g, Uint8 b, Uint8 a){}
+        void copy(SDL_Texture *texture, const SDL_Rect *source, const SDL_Rect *dest){}
+        void copyEx(SDL_Texture *texture, const SDL_Rect *source, const SDL_Rect *dest, double angle, const SDL_Point *center, SDL_RendererFlip flip){}
+        void fillRects(const SDL_Rect *rects, int count, Uint8 r, Uint8 g, Uint8 b, Uint8 a){}
+        void geometry(SDL_Texture *texture, const SDL_Vertex *vertices, int vertex_count, const int *indices, int index_count){}
+};
@@ -0,0 +1,316 @@
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "game-classes.hpp"
+#include "render-backend.hpp"
+#include "world.hpp"
+#include "save-state.hpp"
+
+using namespace std;
+
+#pragma once
+
+// keeps the last few seconds of world states in a fixed amount of memory, hold r to scrub backwards.
+//
+// every capture is a whole-chunk save state (see save-state.hpp), stored as the xor with the capture
+// before it, run length encoded. most of a chunk doesn't change between ticks, so most of the xor is zeros.
+// xor works both ways, so stepping back from the newest state is one delta per step. every
+// keyframe_every captures the state is also stored on its own, so any capture can be rebuilt from the
+// keyframe before it, and the oldest captures can be dropped a keyframe group at a time.
+//
+// encoding: length of the state, then repeated [zero run][literal run][literal bytes], runs as 7 bit varints.
+
+struct RewindFrame{
+    long long tick;
+    Uint32 size; // size of the save state
+    vector<Uint8> delta; // xor with the previous capture (empty for the oldest one)
+    vector<Uint8> keyframe; // the state on its own (only on keyframes)
+};
+
+class RewindBuffer{
+    public:
+        // limits
+        size_t memory_limit;
+        int max_frames;
+        int keyframe_every; // captures
+        int capture_every; // ticks
+        float ticks_per_second;
+
+        deque<RewindFrame> frames;
+        size_t memory_used = 0;
+        int captures_since_keyframe = 0;
+
+        // newest captured state, and the state at the cursor while scrubbing
+        vector<Uint8> newest_state;
+        vector<Uint8> state;
+        int cursor = -1; // -1 = not scrubbing
+
+        // scratch
+        vector<Uint8> diff;
+        vector<Uint8> encoded;
+
+        // cost of a capture
+        float last_capture_us = 0;
+        float average_capture_us = 0;
+        float max_capture_us = 0;
+
+        // methods
+        RewindBuffer(float seconds, float ticks_per_second_, size_t memory_limit_, int keyframe_every_ = 120, int capture_every_ = 1);
+        void capture(World &world);
+        bool stepBack(World &world, int steps = 1);
+        bool seek(World &world, int index);
+        void resume();
+        void clear();
+        float secondsKept();
+        void renderDebug(RenderBackend &render, Camera &camera, FontRenderer &font_renderer, int x, int y);
+
+        void trim();
+        void encodeXor(const vector<Uint8> &a, const vector<Uint8> &b, vector<Uint8> &out);
+        void applyXor(const vector<Uint8> &encoded_, vector<Uint8> &dest);
+};
+
+RewindBuffer::RewindBuffer(float seconds, float ticks_per_second_, size_t memory_limit_, int keyframe_every_, int capture_every_){
+    memory_limit = memory_limit_;
+    ticks_per_second = ticks_per_second_;
+    keyframe_every = max(keyframe_every_, 1);
+    capture_every = max(capture_every_, 1);
+    max_frames = max(int(seconds * ticks_per_second / capture_every), 2);
+}
+
+void writeVarint(vector<Uint8> &out, size_t value){
+    while (value >= 0x80){
+        out.push_back(Uint8(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(Uint8(value));
+}
+
+size_t readVarint(const Uint8 *&data, const Uint8 *end){
+    size_t value = 0;
+    int shift = 0;
+    while (data != end && shift < 64){
+        Uint8 byte = *data++;
+        value |= size_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)){
+            break;
+        }
+        shift += 7;
+    }
+    return value;
+}
+
+void RewindBuffer::encodeXor(const vector<Uint8> &a, const vector<Uint8> &b, vector<Uint8> &out){
+    // xor of the two (the shorter one counts as zeros past its end)
+    size_t size = max(a.size(), b.size());
+    size_t common = min(a.size(), b.size());
+    diff.resize(size);
+    size_t i = 0;
+    for (; i + 8 <= common; i += 8){
+        Uint64 word_a;
+        Uint64 word_b;
+        memcpy(&word_a, &a[i], 8);
+        memcpy(&word_b, &b[i], 8);
+        word_a ^= word_b;
+        memcpy(&diff[i], &word_a, 8);
+    }
+    for (; i != common; i++){
+        diff[i] = a[i] ^ b[i];
+    }
+    const vector<Uint8> &longer = (a.size() > b.size()) ? a : b;
+    if (size != common){
+        memcpy(&diff[common], &longer[common], size - common);
+    }
+
+    // zero runs / literal runs
+    out.clear();
+    writeVarint(out, size);
+    const Uint8 *data = diff.data();
+    i = 0;
+    while (i != size){
+        size_t zero_start = i;
+        for (Uint64 word; i + 8 <= size && (memcpy(&word, data + i, 8), word == 0); i += 8);
+        for (; i != size && data[i] == 0; i++);
+
+        // literals end at the next run of 4 zeros
+        size_t literal_start = i;
+        for (Uint32 word; i != size && !(data[i] == 0 && i + 4 <= size && (memcpy(&word, data + i, 4), word == 0)); i++);
+
+        writeVarint(out, literal_start - zero_start);
+        writeVarint(out, i - literal_start);
+        out.insert(out.end(), data + literal_start, data + i);
+    }
+}
+
+void RewindBuffer::applyXor(const vector<Uint8> &encoded_, vector<Uint8> &dest){
+    // dest ^= decoded (dest grows with zeros if it is shorter)
+    const Uint8 *data = encoded_.data();
+    const Uint8 *end = data + encoded_.size();
+    size_t size = readVarint(data, end);
+    if (dest.size() < size){
+        dest.resize(size, 0);
+    }
+
+    size_t position = 0;
+    while (data < end){
+        position += readVarint(data, end);
+        size_t literals = readVarint(data, end);
+        if (position + literals > size || literals > size_t(end - data)){
+            cout << "Rewind buffer is damaged\n";
+            return;
+        }
+        for (size_t i = 0; i != literals; i++){
+            dest[position + i] ^= data[i];
+        }
+        position += literals;
+        data += literals;
+    }
+}
+
+void RewindBuffer::capture(World &world){
+    if (world.game_ticks % capture_every != 0){
+        return;
+    }
+    resume();
+
+    auto start = chrono::steady_clock::now();
+
+    saveWorld(world, state, SAVE_WHOLE_CHUNKS);
+
+    RewindFrame frame;
+    frame.tick = world.game_ticks;
+    frame.size = state.size();
+    if (!frames.empty()){
+        encodeXor(state, newest_state, encoded);
+        frame.delta.assign(encoded.begin(), encoded.end());
+    }
+    captures_since_keyframe += 1;
+    if (frames.empty() || captures_since_keyframe >= keyframe_every){
+        encodeXor(state, vector<Uint8>(), encoded);
+        frame.keyframe.assign(encoded.begin(), encoded.end());
+        captures_since_keyframe = 0;
+    }
+    memory_used += frame.delta.size() + frame.keyframe.size();
+    frames.push_back(move(frame));
+    swap(newest_state, state);
+
+    trim();
+
+    last_capture_us = chrono::duration<float, micro>(chrono::steady_clock::now() - start).count();
+    average_capture_us += (last_capture_us - average_capture_us) * 0.05f;
+    max_capture_us = max(max_capture_us, last_capture_us);
+}
+
+void RewindBuffer::trim(){
+    // drop the oldest keyframe group while over a limit (the one being written to always stays)
+    while (memory_used > memory_limit || int(frames.size()) > max_frames){
+        int next_keyframe = 1;
+        while (next_keyframe != int(frames.size()) && frames[next_keyframe].keyframe.empty()){
+            next_keyframe += 1;
+        }
+        if (next_keyframe == int(frames.size())){
+            // only one group left, start a new one next capture so this one can go
+            captures_since_keyframe = keyframe_every;
+            return;
+        }
+
+        for (int i = 0; i != next_keyframe; i++){
+            memory_used -= frames.front().delta.size() + frames.front().keyframe.size();
+            frames.pop_front();
+        }
+
+        // nothing before it any more
+        memory_used -= frames.front().delta.size();
+        frames.front().delta = vector<Uint8>();
+    }
+}
+
+bool RewindBuffer::stepBack(World &world, int steps){
+    if (frames.empty()){
+        return false;
+    }
+    if (cursor == -1){
+        cursor = frames.size() - 1;
+        state = newest_state;
+    }
+
+    // newest ^ delta = the one before, as far back as there are deltas
+    int start_cursor = cursor;
+    for (int step = 0; step != steps && cursor > 0 && !frames[cursor].delta.empty(); step++){
+        applyXor(frames[cursor].delta, state);
+        cursor -= 1;
+        state.resize(frames[cursor].size);
+    }
+    if (cursor == start_cursor){
+        return false;
+    }
+    return loadWorld(world, state.data(), state.size());
+}
+
+bool RewindBuffer::seek(World &world, int index){
+    if (index < 0 || index >= int(frames.size())){
+        return false;
+    }
+
+    // keyframe before it, then deltas forward
+    int keyframe = index;
+    while (frames[keyframe].keyframe.empty()){
+        keyframe -= 1;
+    }
+    state.clear();
+    applyXor(frames[keyframe].keyframe, state);
+    for (int i = keyframe + 1; i <= index; i++){
+        applyXor(frames[i].delta, state);
+        state.resize(frames[i].size);
+    }
+    cursor = index;
+    return loadWorld(world, state.data(), state.size());
+}
+
+void RewindBuffer::resume(){
+    // carry on from the cursor, what came after it is gone
+    if (cursor == -1){
+        return;
+    }
+    while (int(frames.size()) - 1 > cursor){
+        memory_used -= frames.back().delta.size() + frames.back().keyframe.size();
+        frames.pop_back();
+    }
+    swap(newest_state, state);
+    cursor = -1;
+
+    captures_since_keyframe = 0;
+    for (int i = frames.size() - 1; i >= 0 && frames[i].keyframe.empty(); i--){
+        captures_since_keyframe += 1;
+    }
+}
+
+void RewindBuffer::clear(){
+    frames.clear();
+    memory_used = 0;
+    captures_since_keyframe = 0;
+    cursor = -1;
+}
+
+float RewindBuffer::secondsKept(){
+    if (frames.size() < 2){
+        return 0;
+    }
+    return (frames.back().tick - frames.front().tick) / ticks_per_second;
+}
+
+void RewindBuffer::renderDebug(RenderBackend &render, Camera &camera, FontRenderer &font_renderer, int x, int y){
+    ostringstream kept_text;
+    kept_text << "rewind " << int(secondsKept()) << "s " << memory_used / 1024 << "kb";
+    font_renderer.renderText(render, camera, kept_text.str(), x, y, 20, 255, 255, 0);
+
+    ostringstream cost_text;
+    cost_text << "capture " << int(average_capture_us) << "us max " << int(max_capture_us);
+    font_renderer.renderText(render, camera, cost_text.str(), x, y + 20, 20, 255, 255, 0);
+}
@@ -0,0 +1,479 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <string>
+#include <sstream>
+#include <cstring>
+#include <type_traits>
+#include <filesystem>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "ecs.hpp"
+#include "components.hpp"
+#include "world.hpp"
+
+using namespace std;
+
+#pragma once
+
+// binary save states of a whole world (entities, spawn timers, waves, player, camera, random generator, config).
+//
+// layout: header (magic, version, flags, payload size, checksum, component sizes) then the payload.
+// entities are stored archetype by archetype, and every component column is copied straight out of
+// (and back into) the chunk memory, so saving / loading thousands of entities is a handful of memcpys.
+// with SAVE_WHOLE_CHUNKS whole chunks are stored instead of just the used rows: bigger, but every column
+// stays at the same offset from tick to tick, which is what the rewind buffer's deltas need.
+// the header is checked before anything in the world is changed, so a bad file leaves the world alone.
+//
+// textures, sounds and the frame time history aren't saved, the world being loaded into already has them.
+// bump SAVE_VERSION when anything saved by transferWorld changes.
+
+const Uint32 SAVE_MAGIC = 0x5357564F; // "OVWS"
+const Uint32 SAVE_VERSION = 4;
+const int SAVE_HEADER_BYTES = 20 + COMPONENT_COUNT * 4;
+
+// flags
+const Uint32 SAVE_WHOLE_CHUNKS = 1;
+const Uint32 SAVE_FIXED_POINT = 2; // set by saveWorld, positions etc. are 16.16 (see fixed-point.hpp)
+
+Uint32 saveChecksum(const Uint8 *data, size_t size){
+    // fnv-1a style, 8 bytes at a time so it keeps up with memcpy
+    Uint64 hash = 14695981039346656037ull;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8){
+        Uint64 word;
+        memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 1099511628211ull;
+        hash ^= hash >> 29;
+    }
+    for (; i != size; i++){
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    }
+    return Uint32(hash ^ (hash >> 32));
+}
+
+class SaveWriter{
+    public:
+        static const bool reading = false;
+        vector<Uint8> &data;
+        bool ok = true;
+
+        // methods
+        SaveWriter(vector<Uint8> &data_) : data(data_){}
+        void bytes(const void *source, size_t size);
+        template <typename T> void value(const T &source);
+        void text(string &source);
+        void engine(default_random_engine &engine);
+        void distribution(uniform_int_distribution<int> &distribution);
+};
+
+void SaveWriter::bytes(const void *source, size_t size){
+    data.insert(data.end(), (const Uint8*)source, (const Uint8*)source + size);
+}
+
+template <typename T>
+void SaveWriter::value(const T &source){
+    static_assert(is_trivially_copyable<T>::value, "only plain values can be saved directly");
+    bytes(&source, sizeof(T));
+}
+
+void SaveWriter::text(string &source){
+    value(Uint32(source.size()));
+    bytes(source.data(), source.size());
+}
+
+void SaveWriter::engine(default_random_engine &engine){
+    // standard engines only expose their state as text
+    ostringstream state;
+    state << engine;
+    string state_text = state.str();
+    text(state_text);
+}
+
+void SaveWriter::distribution(uniform_int_distribution<int> &distribution){
+    value(distribution.a());
+    value(distribution.b());
+}
+
+class SaveReader{
+    public:
+        static const bool reading = true;
+        const Uint8 *data;
+        size_t size;
+        size_t position = 0;
+        bool ok = true;
+
+        // methods
+        SaveReader(const Uint8 *data_, size_t size_) : data(data_), size(size_){}
+        void bytes(void *dest, size_t count);
+        template <typename T> void value(T &dest);
+        void text(string &dest);
+        void engine(default_random_engine &engine);
+        void distribution(uniform_int_distribution<int> &distribution);
+        const Uint8* skip(size_t count);
+};
+
+const Uint8* SaveReader::skip(size_t count){
+    if (!ok || count > size - position){
+        ok = false;
+        return NULL;
+    }
+    const Uint8 *start = data + position;
+    position += count;
+    return start;
+}
+
+void SaveReader::bytes(void *dest, size_t count){
+    const Uint8 *source = skip(count);
+    if (source){
+        memcpy(dest, source, count);
+    }
+}
+
+template <typename T>
+void SaveReader::value(T &dest){
+    static_assert(is_trivially_copyable<T>::value, "only plain values can be saved directly");
+    bytes(&dest, sizeof(T));
+}
+
+void SaveReader::text(string &dest){
+    Uint32 length = 0;
+    value(length);
+    const Uint8 *source = skip(length);
+    if (source){
+        dest.assign((const char*)source, length);
+    }
+}
+
+void SaveReader::engine(default_random_engine &engine){
+    string state_text;
+    text(state_text);
+    istringstream state(state_text);
+    state >> engine;
+}
+
+void SaveReader::distribution(uniform_int_distribution<int> &distribution){
+    int a = 0;
+    int b = 0;
+    value(a);
+    value(b);
+    distribution = uniform_int_distribution<int>(a, b);
+}
+
+template <typename Archive>
+void transferConfig(ConfigSections &sections, Archive &archive){
+    Uint32 section_count = sections.size();
+    archive.value(section_count);
+    if (!Archive::reading){
+        // sorted, so the same values always save to the same bytes
+        map<string, map<string, float>> sorted;
+        for (auto& [section, values]: sections){
+            sorted[section].insert(values.begin(), values.end());
+        }
+        for (auto& [section, values]: sorted){
+            string section_name = section;
+            archive.text(section_name);
+            Uint32 value_count = values.size();
+            archive.value(value_count);
+            for (auto& [key, value]: values){
+                string key_name = key;
+                archive.text(key_name);
+                archive.value(value);
+            }
+        }
+        return;
+    }
+
+    sections.clear();
+    for (Uint32 i = 0; i != section_count && archive.ok; i++){
+        string section_name;
+        Uint32 value_count = 0;
+        archive.text(section_name);
+        archive.value(value_count);
+        for (Uint32 j = 0; j != value_count && archive.ok; j++){
+            string key_name;
+            float value = 0;
+            archive.text(key_name);
+            archive.value(value);
+            sections[section_name][key_name] = value;
+        }
+    }
+}
+
+template <typename Archive>
+void transferWorld(World &world, Archive &archive){
+    // game
+    archive.value(world.game_ticks);
+    archive.value(world.game_state);
+    archive.engine(world.rand_generator);
+
+    // waves and spawning
+    archive.value(world.wave);
+    archive.value(world.max_enemies);
+    archive.value(world.next_spawn_tick);
+    archive.value(world.spawned_already);
+    archive.value(world.next_wave_tick);
+    archive.distribution(world.rand_spawn_ticks);
+    archive.value(world.wave_text_x);
+    archive.value(world.wave_start);
+
+    // config values in use
+    transferConfig(world.enemy_data, archive);
+    ConfigSections waves = {{"waves", world.wave_data}};
+    transferConfig(waves, archive);
+    if (Archive::reading){
+        world.wave_data = waves["waves"];
+    }
+
+    // player
+    Player &player = world.player;
+    archive.value(player.x);
+    archive.value(player.y);
+    archive.value(player.speed);
+    archive.value(player.damage);
+    archive.value(player.health);
+    archive.value(player.max_health);
+    archive.value(player.heart_rect);
+    archive.value(player.heart_rad);
+    archive.value(player.heart_shrink);
+    archive.value(player.display_rect);
+    archive.value(player.rect);
+    archive.value(world.player_death_explosion);
+    archive.value(world.death_transition_alpha);
+
+    // camera
+    archive.value(world.camera.x);
+    archive.value(world.camera.y);
+    archive.value(world.camera.shake_time);
+    archive.distribution(world.camera.rand_coord);
+
+    // effects that change what happens (explosion thinning, particle counts)
+    for (QualityTunable &tunable: world.quality_governor.tunables){
+        archive.value(tunable.level);
+    }
+    archive.value(world.quality_governor.explosion_counter);
+    archive.value(world.bloom_enabled);
+
+    // menu and background
+    archive.text(world.menu_selected);
+    for (string selection: {"play", "options", "exit"}){
+        archive.value(world.menu_selections[selection]["size"]);
+    }
+    archive.value(world.new_attack_angle);
+    archive.value(world.background_1);
+    archive.value(world.background_2);
+}
+
+void saveEntities(EntityRegistry &entities, SaveWriter &writer, bool whole_chunks){
+    writer.value(Uint32(entities.records.size()));
+    writer.bytes(entities.records.data(), entities.records.size() * sizeof(EntityRecord));
+    writer.value(Uint32(entities.free_records.size()));
+    writer.bytes(entities.free_records.data(), entities.free_records.size() * sizeof(Uint32));
+    writer.value(entities.entity_count);
+
+    writer.value(Uint32(entities.archetypes.size()));
+    for (Archetype *archetype: entities.archetypes){
+        writer.value(archetype -> mask);
+        writer.value(archetype -> count);
+
+        // only the used part of every column (or every used chunk as it is)
+        for (int chunk = 0; chunk * archetype -> capacity < archetype -> count; chunk++){
+            if (whole_chunks){
+                writer.bytes(archetype -> chunks[chunk] -> data, ECS_CHUNK_BYTES);
+                continue;
+            }
+            int rows = archetype -> chunkCount(chunk);
+            writer.bytes(archetype -> entities(chunk), rows * sizeof(Entity));
+            for (int id: archetype -> component_ids){
+                writer.bytes(archetype -> column(chunk, id), rows * archetype -> component_sizes[id]);
+            }
+        }
+    }
+}
+
+bool loadEntities(EntityRegistry &entities, SaveReader &reader, bool whole_chunks){
+    Uint32 record_count = 0;
+    reader.value(record_count);
+    const Uint8 *records = reader.skip(size_t(record_count) * sizeof(EntityRecord));
+    Uint32 free_count = 0;
+    reader.value(free_count);
+    const Uint8 *free_records = reader.skip(size_t(free_count) * sizeof(Uint32));
+    int entity_count = 0;
+    reader.value(entity_count);
+    Uint32 archetype_count = 0;
+    reader.value(archetype_count);
+    if (!reader.ok || archetype_count > (reader.size - reader.position) / (sizeof(ComponentMask) + sizeof(int))){
+        return false;
+    }
+
+    entities.records.resize(record_count);
+    memcpy(entities.records.data(), records, size_t(record_count) * sizeof(EntityRecord));
+    entities.free_records.resize(free_count);
+    memcpy(entities.free_records.data(), free_records, size_t(free_count) * sizeof(Uint32));
+    entities.entity_count = entity_count;
+
+    // archetypes in the same order, so records still point at the right ones.
+    // ones that already match are kept (with their chunks), the rest are replaced
+    for (Uint32 a = archetype_count; a < entities.archetypes.size(); a++){
+        delete entities.archetypes[a];
+    }
+    entities.archetypes.resize(min(size_t(archetype_count), entities.archetypes.size()));
+
+    for (Uint32 a = 0; a != archetype_count; a++){
+        ComponentMask mask = 0;
+        int count = 0;
+        reader.value(mask);
+        reader.value(count);
+        if (!reader.ok || count < 0){
+            return false;
+        }
+
+        if (a == entities.archetypes.size() || entities.archetypes[a] -> mask != mask){
+            vector<pair<int, int>> components;
+            for (int id = 0; id != COMPONENT_COUNT; id++){
+                if (mask & (ComponentMask(1) << id)){
+                    components.push_back({id, COMPONENT_SIZES[id]});
+                }
+            }
+            Archetype *archetype = new Archetype(mask, components);
+            if (a == entities.archetypes.size()){
+                entities.archetypes.push_back(archetype);
+            } else {
+                delete entities.archetypes[a];
+                entities.archetypes[a] = archetype;
+            }
+        }
+
+        Archetype *archetype = entities.archetypes[a];
+        archetype -> count = count;
+        while (int(archetype -> chunks.size()) * archetype -> capacity < count){
+            archetype -> chunks.push_back(new EntityChunk());
+        }
+        for (int chunk = 0; chunk * archetype -> capacity < count; chunk++){
+            if (whole_chunks){
+                reader.bytes(archetype -> chunks[chunk] -> data, ECS_CHUNK_BYTES);
+                continue;
+            }
+            int rows = archetype -> chunkCount(chunk);
+            reader.bytes(archetype -> entities(chunk), rows * sizeof(Entity));
+            for (int id: archetype -> component_ids){
+                reader.bytes(archetype -> column(chunk, id), rows * archetype -> component_sizes[id]);
+            }
+        }
+    }
+    return reader.ok;
+}
+
+void saveWorld(World &world, vector<Uint8> &data, Uint32 flags = 0){
+    // room for the entities plus a bit for everything else, so the buffer isn't regrown while writing
+    size_t estimate = 4096 + world.entities.records.size() * (sizeof(EntityRecord) + sizeof(Uint32));
+    for (Archetype *archetype: world.entities.archetypes){
+        estimate += (archetype -> count + archetype -> capacity) * (ECS_CHUNK_BYTES / archetype -> capacity);
+    }
+    data.clear();
+    data.reserve(estimate);
+    SaveWriter writer(data);
+
+    // header, size and checksum filled in at the end
+    if (PHYSICS_FIXED_POINT){
+        flags |= SAVE_FIXED_POINT;
+    }
+    writer.value(SAVE_MAGIC);
+    writer.value(SAVE_VERSION);
+    writer.value(flags);
+    writer.value(Uint32(0));
+    writer.value(Uint32(0));
+    for (int id = 0; id != COMPONENT_COUNT; id++){
+        writer.value(Uint32(COMPONENT_SIZES[id]));
+    }
+
+    transferWorld(world, writer);
+    saveEntities(world.entities, writer, flags & SAVE_WHOLE_CHUNKS);
+
+    Uint32 payload_size = data.size() - SAVE_HEADER_BYTES;
+    Uint32 checksum = saveChecksum(data.data() + SAVE_HEADER_BYTES, payload_size);
+    memcpy(data.data() + 12, &payload_size, 4);
+    memcpy(data.data() + 16, &checksum, 4);
+}
+
+bool loadWorld(World &world, const Uint8 *data, size_t size){
+    SaveReader reader(data, size);
+
+    // check everything before touching the world
+    Uint32 magic = 0;
+    Uint32 version = 0;
+    Uint32 flags = 0;
+    Uint32 payload_size = 0;
+    Uint32 checksum = 0;
+    reader.value(magic);
+    reader.value(version);
+    reader.value(flags);
+    reader.value(payload_size);
+    reader.value(checksum);
+    if (!reader.ok || magic != SAVE_MAGIC){
+        cout << "Not a save state\n";
+        return false;
+    }
+    if (version != SAVE_VERSION){
+        cout << "Save state version " << version << " can't be loaded (this is version " << SAVE_VERSION << ")\n";
+        return false;
+    }
+    if (bool(flags & SAVE_FIXED_POINT) != PHYSICS_FIXED_POINT){
+        cout << "Save state was made with " << (PHYSICS_FIXED_POINT ? "float" : "fixed point") << " physics\n";
+        return false;
+    }
+    for (int id = 0; id != COMPONENT_COUNT; id++){
+        Uint32 component_size = 0;
+        reader.value(component_size);
+        if (reader.ok && component_size != Uint32(COMPONENT_SIZES[id])){
+            cout << "Save state was made with different components\n";
+            return false;
+        }
+    }
+    if (!reader.ok || payload_size != size - SAVE_HEADER_BYTES || saveChecksum(data + SAVE_HEADER_BYTES, payload_size) != checksum){
+        cout << "Save state is damaged\n";
+        return false;
+    }
+
+    transferWorld(world, reader);
+    world.applyAnimationTiming();
+    if (!loadEntities(world.entities, reader, flags & SAVE_WHOLE_CHUNKS)){
+        cout << "Save state is damaged\n";
+        return false;
+    }
+
+    // timers aren't saved, the components know when they're due
+    world.timers.clear(world.game_ticks);
+    scheduleEnemyTimers(world.entities, world.timers);
+    return true;
+}
+
+bool saveWorldFile(World &world, string path){
+    vector<Uint8> data;
+    saveWorld(world, data);
+
+    filesystem::path parent = filesystem::path(path).parent_path();
+    if (!parent.empty()){
+        error_code error;
+        filesystem::create_directories(parent, error);
+    }
+
+    ofstream file(path, ios::binary);
+    file.write((const char*)data.data(), data.size());
+    if (!file){
+        cout << "Couldn't write save state: " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool loadWorldFile(World &world, string path){
+    ifstream file(path, ios::binary);
+    if (!file){
+        cout << "Couldn't open save state: " << path << "\n";
+        return false;
+    }
+    vector<Uint8> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    return loadWorld(world, data.data(), data.size());
+}
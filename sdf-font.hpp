@@ -0,0 +1,467 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include "SDL2/include/SDL2/SDL.h"
+
+using namespace std;
+
+#pragma once
+
+// printable ascii glyphs read straight from a truetype file (glyf outlines, no hinting or kerning), and a
+// signed distance field of each one packed into one atlas.
+//
+// outlines are flattened to line segments in em units (y up). the distance field stores, per pixel,
+// the distance to the nearest edge (128 = on the edge, more is inside) at SDF_EM_PIXELS pixels per em,
+// out to SDF_SPREAD pixels either side, so it can be sampled for text of any size.
+
+const int FONT_FIRST_CHAR = 32;
+const int FONT_LAST_CHAR = 126;
+const int FONT_CURVE_STEPS = 6; // line segments per quadratic curve
+const int SDF_EM_PIXELS = 48;
+const int SDF_SPREAD = 6;
+const int SDF_ATLAS_WIDTH = 1024;
+
+struct FontSegment{
+    float x0, y0, x1, y1;
+};
+
+struct FontGlyph{
+    float advance = 0; // em
+    float x0 = 0, y0 = 0, x1 = 0, y1 = 0; // outline box, em
+    vector<FontSegment> segments;
+
+    // cell in the distance field atlas
+    int sdf_x = 0, sdf_y = 0, sdf_width = 0, sdf_height = 0;
+};
+
+class SDFFont{
+    public:
+        bool loaded = false;
+        float ascent = 0; // em, above the baseline
+        float descent = 0; // em, below the baseline (negative)
+        vector<FontGlyph> glyphs; // FONT_FIRST_CHAR to FONT_LAST_CHAR
+
+        vector<Uint8> sdf;
+        int sdf_width = 0;
+        int sdf_height = 0;
+
+        // methods
+        bool load(string path);
+        void buildSDF();
+        FontGlyph* glyph(char c);
+        float distance(FontGlyph &glyph, float x, float y);
+};
+
+// big endian reads, out of range reads as 0
+Uint8 ttfU8(const vector<Uint8> &data, size_t at){
+    return (at < data.size()) ? data[at] : 0;
+}
+
+Uint16 ttfU16(const vector<Uint8> &data, size_t at){
+    if (at + 2 > data.size()){
+        return 0;
+    }
+    return data[at] << 8 | data[at + 1];
+}
+
+Sint16 ttfS16(const vector<Uint8> &data, size_t at){
+    return Sint16(ttfU16(data, at));
+}
+
+Uint32 ttfU32(const vector<Uint8> &data, size_t at){
+    return Uint32(ttfU16(data, at)) << 16 | ttfU16(data, at + 2);
+}
+
+size_t ttfTable(const vector<Uint8> &data, const char *tag){
+    int tables = ttfU16(data, 4);
+    for (int i = 0; i != tables; i++){
+        size_t record = 12 + i * 16;
+        if (record + 16 <= data.size() && equal(tag, tag + 4, data.begin() + record)){
+            return ttfU32(data, record + 8);
+        }
+    }
+    return 0;
+}
+
+int ttfGlyphIndex(const vector<Uint8> &data, size_t cmap, int c){
+    // first unicode (3 1 / 0 x) subtable in format 4
+    int subtables = ttfU16(data, cmap + 2);
+    for (int i = 0; i != subtables; i++){
+        int platform = ttfU16(data, cmap + 4 + i * 8);
+        int encoding = ttfU16(data, cmap + 6 + i * 8);
+        size_t subtable = cmap + ttfU32(data, cmap + 8 + i * 8);
+        if (!((platform == 3 && encoding == 1) || platform == 0) || ttfU16(data, subtable) != 4){
+            continue;
+        }
+
+        int segments_x2 = ttfU16(data, subtable + 6);
+        size_t end_codes = subtable + 14;
+        size_t start_codes = end_codes + segments_x2 + 2;
+        size_t id_deltas = start_codes + segments_x2;
+        size_t id_range_offsets = id_deltas + segments_x2;
+        for (int segment = 0; segment < segments_x2; segment += 2){
+            if (c > ttfU16(data, end_codes + segment)){
+                continue;
+            }
+            int start = ttfU16(data, start_codes + segment);
+            if (c < start){
+                return 0;
+            }
+            int delta = ttfU16(data, id_deltas + segment);
+            int range_offset = ttfU16(data, id_range_offsets + segment);
+            if (range_offset == 0){
+                return (c + delta) & 0xFFFF;
+            }
+            int glyph = ttfU16(data, id_range_offsets + segment + range_offset + (c - start) * 2);
+            return (glyph == 0) ? 0 : (glyph + delta) & 0xFFFF;
+        }
+    }
+    return 0;
+}
+
+void fontLine(vector<FontSegment> &segments, float x0, float y0, float x1, float y1){
+    if (x0 != x1 || y0 != y1){
+        segments.push_back({x0, y0, x1, y1});
+    }
+}
+
+void fontCurve(vector<FontSegment> &segments, float x0, float y0, float cx, float cy, float x1, float y1){
+    float last_x = x0;
+    float last_y = y0;
+    for (int step = 1; step <= FONT_CURVE_STEPS; step++){
+        float t = float(step) / FONT_CURVE_STEPS;
+        float x = (1 - t) * (1 - t) * x0 + 2 * (1 - t) * t * cx + t * t * x1;
+        float y = (1 - t) * (1 - t) * y0 + 2 * (1 - t) * t * cy + t * t * y1;
+        fontLine(segments, last_x, last_y, x, y);
+        last_x = x;
+        last_y = y;
+    }
+}
+
+void fontContour(vector<FontSegment> &segments, vector<float> &xs, vector<float> &ys, vector<bool> &on, int first, int last){
+    // on / off curve points to lines and quadratic curves, two off points in a row have an on point between them
+    int count = last - first + 1;
+    if (count < 2){
+        return;
+    }
+
+    int first_on = -1;
+    for (int i = 0; i != count; i++){
+        if (on[first + i]){
+            first_on = i;
+            break;
+        }
+    }
+
+    int begin;
+    float start_x, start_y;
+    if (first_on != -1){
+        begin = first_on + 1;
+        start_x = xs[first + first_on];
+        start_y = ys[first + first_on];
+    } else {
+        begin = 1;
+        start_x = (xs[first] + xs[first + 1]) / 2;
+        start_y = (ys[first] + ys[first + 1]) / 2;
+    }
+
+    float pen_x = start_x, pen_y = start_y;
+    float control_x = 0, control_y = 0;
+    bool has_control = false;
+    for (int i = begin; i != begin + count; i++){
+        int point = first + i % count;
+        float x = xs[point];
+        float y = ys[point];
+        if (on[point]){
+            if (has_control){
+                fontCurve(segments, pen_x, pen_y, control_x, control_y, x, y);
+            } else {
+                fontLine(segments, pen_x, pen_y, x, y);
+            }
+            has_control = false;
+            pen_x = x;
+            pen_y = y;
+        } else {
+            if (has_control){
+                float middle_x = (control_x + x) / 2;
+                float middle_y = (control_y + y) / 2;
+                fontCurve(segments, pen_x, pen_y, control_x, control_y, middle_x, middle_y);
+                pen_x = middle_x;
+                pen_y = middle_y;
+            }
+            control_x = x;
+            control_y = y;
+            has_control = true;
+        }
+    }
+
+    if (has_control){
+        fontCurve(segments, pen_x, pen_y, control_x, control_y, start_x, start_y);
+    } else {
+        fontLine(segments, pen_x, pen_y, start_x, start_y);
+    }
+}
+
+void ttfOutline(const vector<Uint8> &data, size_t glyf, size_t loca, int long_loca, int glyph_count, int glyph, const float matrix[6], vector<FontSegment> &segments, int depth = 0){
+    // matrix maps font units to em: x' = a x + c y + e, y' = b x + d y + f
+    if (glyph < 0 || glyph >= glyph_count || depth > 8){
+        return;
+    }
+    size_t start = long_loca ? ttfU32(data, loca + glyph * 4) : ttfU16(data, loca + glyph * 2) * 2;
+    size_t end = long_loca ? ttfU32(data, loca + glyph * 4 + 4) : ttfU16(data, loca + glyph * 2 + 2) * 2;
+    if (end <= start){
+        return; // no outline (space)
+    }
+
+    size_t at = glyf + start;
+    int contours = ttfS16(data, at);
+
+    if (contours >= 0){
+        int point_count = (contours == 0) ? 0 : ttfU16(data, at + 10 + (contours - 1) * 2) + 1;
+        size_t p = at + 12 + contours * 2 + ttfU16(data, at + 10 + contours * 2);
+
+        // flags (a flag with bit 3 is followed by how many times it repeats)
+        vector<Uint8> flags(point_count);
+        for (int i = 0; i < point_count; i++){
+            Uint8 flag = ttfU8(data, p++);
+            flags[i] = flag;
+            if (flag & 8){
+                int repeat = ttfU8(data, p++);
+                while (repeat-- > 0 && i + 1 < point_count){
+                    flags[++i] = flag;
+                }
+            }
+        }
+
+        // deltas: short (1 byte, bit 4/5 is the sign) or long, or unchanged
+        vector<float> xs(point_count), ys(point_count);
+        vector<bool> on(point_count);
+        int value = 0;
+        for (int i = 0; i != point_count; i++){
+            if (flags[i] & 2){
+                value += (flags[i] & 16) ? ttfU8(data, p) : -ttfU8(data, p);
+                p += 1;
+            } else if (!(flags[i] & 16)){
+                value += ttfS16(data, p);
+                p += 2;
+            }
+            xs[i] = value;
+        }
+        value = 0;
+        for (int i = 0; i != point_count; i++){
+            if (flags[i] & 4){
+                value += (flags[i] & 32) ? ttfU8(data, p) : -ttfU8(data, p);
+                p += 1;
+            } else if (!(flags[i] & 32)){
+                value += ttfS16(data, p);
+                p += 2;
+            }
+            ys[i] = value;
+            on[i] = flags[i] & 1;
+        }
+
+        for (int i = 0; i != point_count; i++){
+            float x = xs[i];
+            float y = ys[i];
+            xs[i] = matrix[0] * x + matrix[2] * y + matrix[4];
+            ys[i] = matrix[1] * x + matrix[3] * y + matrix[5];
+        }
+
+        int first = 0;
+        for (int contour = 0; contour != contours; contour++){
+            int last = min(int(ttfU16(data, at + 10 + contour * 2)), point_count - 1);
+            fontContour(segments, xs, ys, on, first, last);
+            first = last + 1;
+        }
+        return;
+    }
+
+    // composite, other glyphs moved / scaled (offsets only, not point matching)
+    size_t p = at + 10;
+    Uint16 flags;
+    do {
+        flags = ttfU16(data, p);
+        int component = ttfU16(data, p + 2);
+        p += 4;
+
+        float dx, dy;
+        if (flags & 1){
+            dx = ttfS16(data, p);
+            dy = ttfS16(data, p + 2);
+            p += 4;
+        } else {
+            dx = Sint8(ttfU8(data, p));
+            dy = Sint8(ttfU8(data, p + 1));
+            p += 2;
+        }
+        if (!(flags & 2)){
+            dx = 0;
+            dy = 0;
+        }
+
+        float a = 1, b = 0, c = 0, d = 1;
+        if (flags & 8){
+            a = d = ttfS16(data, p) / 16384.0f;
+            p += 2;
+        } else if (flags & 0x40){
+            a = ttfS16(data, p) / 16384.0f;
+            d = ttfS16(data, p + 2) / 16384.0f;
+            p += 4;
+        } else if (flags & 0x80){
+            a = ttfS16(data, p) / 16384.0f;
+            b = ttfS16(data, p + 2) / 16384.0f;
+            c = ttfS16(data, p + 4) / 16384.0f;
+            d = ttfS16(data, p + 6) / 16384.0f;
+            p += 8;
+        }
+
+        float combined[6] = {
+            matrix[0] * a + matrix[2] * b,
+            matrix[1] * a + matrix[3] * b,
+            matrix[0] * c + matrix[2] * d,
+            matrix[1] * c + matrix[3] * d,
+            matrix[0] * dx + matrix[2] * dy + matrix[4],
+            matrix[1] * dx + matrix[3] * dy + matrix[5],
+        };
+        ttfOutline(data, glyf, loca, long_loca, glyph_count, component, combined, segments, depth + 1);
+    } while ((flags & 0x20) && p < data.size());
+}
+
+bool SDFFont::load(string path){
+    ifstream file(path, ios::binary);
+    vector<Uint8> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    if (!file.is_open() || data.size() < 12){
+        cout << "Error loading font: " << path << "\n";
+        return false;
+    }
+
+    size_t head = ttfTable(data, "head");
+    size_t hhea = ttfTable(data, "hhea");
+    size_t maxp = ttfTable(data, "maxp");
+    size_t hmtx = ttfTable(data, "hmtx");
+    size_t cmap = ttfTable(data, "cmap");
+    size_t loca = ttfTable(data, "loca");
+    size_t glyf = ttfTable(data, "glyf");
+    if (!head || !hhea || !maxp || !hmtx || !cmap || !loca || !glyf){
+        cout << "Error loading font: " << path << " isn't a truetype font with glyf outlines\n";
+        return false;
+    }
+
+    float units_per_em = max(int(ttfU16(data, head + 18)), 1);
+    int long_loca = ttfS16(data, head + 50);
+    int glyph_count = ttfU16(data, maxp + 4);
+    int metrics_count = max(int(ttfU16(data, hhea + 34)), 1);
+    ascent = ttfS16(data, hhea + 4) / units_per_em;
+    descent = ttfS16(data, hhea + 6) / units_per_em;
+
+    const float matrix[6] = {1 / units_per_em, 0, 0, 1 / units_per_em, 0, 0};
+    glyphs.assign(FONT_LAST_CHAR - FONT_FIRST_CHAR + 1, FontGlyph());
+    for (int c = FONT_FIRST_CHAR; c <= FONT_LAST_CHAR; c++){
+        FontGlyph &glyph = glyphs[c - FONT_FIRST_CHAR];
+        int index = ttfGlyphIndex(data, cmap, c);
+        glyph.advance = ttfU16(data, hmtx + min(index, metrics_count - 1) * 4) / units_per_em;
+        ttfOutline(data, glyf, loca, long_loca, glyph_count, index, matrix, glyph.segments);
+
+        if (!glyph.segments.empty()){
+            glyph.x0 = glyph.y0 = 1e9f;
+            glyph.x1 = glyph.y1 = -1e9f;
+            for (FontSegment &segment : glyph.segments){
+                glyph.x0 = min({glyph.x0, segment.x0, segment.x1});
+                glyph.y0 = min({glyph.y0, segment.y0, segment.y1});
+                glyph.x1 = max({glyph.x1, segment.x0, segment.x1});
+                glyph.y1 = max({glyph.y1, segment.y0, segment.y1});
+            }
+        }
+    }
+
+    loaded = true;
+    return true;
+}
+
+void SDFFont::buildSDF(){
+    // pack cells in rows
+    int x = 0, y = 0, row_height = 0;
+    for (FontGlyph &glyph : glyphs){
+        if (glyph.segments.empty()){
+            continue;
+        }
+        glyph.sdf_width = ceil((glyph.x1 - glyph.x0) * SDF_EM_PIXELS) + SDF_SPREAD * 2;
+        glyph.sdf_height = ceil((glyph.y1 - glyph.y0) * SDF_EM_PIXELS) + SDF_SPREAD * 2;
+        if (x + glyph.sdf_width > SDF_ATLAS_WIDTH){
+            x = 0;
+            y += row_height;
+            row_height = 0;
+        }
+        glyph.sdf_x = x;
+        glyph.sdf_y = y;
+        x += glyph.sdf_width;
+        row_height = max(row_height, glyph.sdf_height);
+    }
+    sdf_width = SDF_ATLAS_WIDTH;
+    sdf_height = y + row_height;
+    sdf.assign(sdf_width * sdf_height, 0);
+
+    // distance to the nearest segment, inside where the winding number isn't 0
+    for (FontGlyph &glyph : glyphs){
+        for (int j = 0; j < glyph.sdf_height; j++){
+            float py = glyph.y1 - (j + 0.5f - SDF_SPREAD) / SDF_EM_PIXELS;
+            for (int i = 0; i < glyph.sdf_width; i++){
+                float px = glyph.x0 + (i + 0.5f - SDF_SPREAD) / SDF_EM_PIXELS;
+
+                float nearest = 1e9f;
+                int winding = 0;
+                for (FontSegment &segment : glyph.segments){
+                    float dx = segment.x1 - segment.x0;
+                    float dy = segment.y1 - segment.y0;
+                    float t = clamp(((px - segment.x0) * dx + (py - segment.y0) * dy) / (dx * dx + dy * dy), 0.0f, 1.0f);
+                    float ex = segment.x0 + dx * t - px;
+                    float ey = segment.y0 + dy * t - py;
+                    nearest = min(nearest, ex * ex + ey * ey);
+
+                    if ((segment.y0 <= py) != (segment.y1 <= py)){
+                        float cross_x = segment.x0 + (py - segment.y0) * dx / dy;
+                        if (cross_x > px){
+                            winding += (dy > 0) ? 1 : -1;
+                        }
+                    }
+                }
+
+                float signed_pixels = sqrt(nearest) * SDF_EM_PIXELS * (winding != 0 ? 1 : -1);
+                sdf[(glyph.sdf_y + j) * sdf_width + glyph.sdf_x + i] = clamp(128 + signed_pixels / SDF_SPREAD * 127, 0.0f, 255.0f);
+            }
+        }
+    }
+}
+
+FontGlyph* SDFFont::glyph(char c){
+    if (!loaded || c < FONT_FIRST_CHAR || c > FONT_LAST_CHAR){
+        return NULL;
+    }
+    return &glyphs[c - FONT_FIRST_CHAR];
+}
+
+float SDFFont::distance(FontGlyph &glyph, float x, float y){
+    // signed distance (em, positive inside) at a point in em units, bilinear between pixels
+    float far = -float(SDF_SPREAD) / SDF_EM_PIXELS;
+    if (glyph.sdf_width == 0){
+        return far;
+    }
+    float fx = (x - glyph.x0) * SDF_EM_PIXELS + SDF_SPREAD - 0.5f;
+    float fy = (glyph.y1 - y) * SDF_EM_PIXELS + SDF_SPREAD - 0.5f;
+    if (fx < 0 || fy < 0 || fx > glyph.sdf_width - 1 || fy > glyph.sdf_height - 1){
+        return far;
+    }
+
+    int ix = min(int(fx), glyph.sdf_width - 2);
+    int iy = min(int(fy), glyph.sdf_height - 2);
+    float tx = fx - ix;
+    float ty = fy - iy;
+    const Uint8 *row = &sdf[(glyph.sdf_y + iy) * sdf_width + glyph.sdf_x + ix];
+    float top = row[0] + (row[1] - row[0]) * tx;
+    float bottom = row[sdf_width] + (row[sdf_width + 1] - row[sdf_width]) * tx;
+    float value = top + (bottom - top) * ty;
+    return (value - 128) / 127 * SDF_SPREAD / SDF_EM_PIXELS;
+}
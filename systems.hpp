@@ -0,0 +1,245 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <random>
+#include <cmath>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "functions.hpp"
+#include "game-classes.hpp"
+#include "animation.hpp"
+#include "ecs.hpp"
+#include "components.hpp"
+#include "bloom.hpp"
+#include "render-backend.hpp"
+#include "timer-wheel.hpp"
+
+using namespace std;
+
+#pragma once
+
+// systems that work on any entity with the right components
+
+void moveSystem(EntityRegistry &entities){
+    entities.each<Position, Velocity>([&](Entity entity, Position &position, Velocity &velocity){
+        position.x += velocity.x;
+        position.y += velocity.y;
+    });
+
+    entities.each<Velocity, Gravity>([&](Entity entity, Velocity &velocity, Gravity &gravity){
+        velocity.y += gravity.gravity;
+    });
+}
+
+void fadeSystem(EntityRegistry &entities){
+    entities.each<Sprite, Fade>([&](Entity entity, Sprite &sprite, Fade &fade){
+        sprite.alpha -= fade.lose_alpha;
+        if (sprite.alpha <= 1){
+            entities.destroy(entity);
+        }
+    });
+
+    entities.each<Sprite, FadeIn>([&](Entity entity, Sprite &sprite, FadeIn &fade_in){
+        if (sprite.alpha != 255){
+            sprite.alpha += min(fade_in.speed, 255 - sprite.alpha);
+        }
+    });
+}
+
+void boundsSystem(EntityRegistry &entities){
+    entities.each<Position, Bounds>([&](Entity entity, Position &position, Bounds &bounds){
+        if (!(position.x > bounds.min_x && position.x < bounds.max_x && position.y > bounds.min_y && position.y < bounds.max_y)){
+            entities.destroy(entity);
+        }
+    });
+}
+
+void scheduleWanderTimers(TimerWheel &timers, Entity entity, Wander &wander){
+    timers.schedule(entity, TIMER_WANDER_RETARGET, wander.next_move_tick);
+    if (Sint32(wander.arrive_tick - wander.move_tick) > 0){
+        timers.schedule(entity, TIMER_WANDER_MOVE, wander.move_tick);
+        timers.schedule(entity, TIMER_WANDER_ARRIVE, wander.arrive_tick);
+    }
+}
+
+void wanderSystem(EntityRegistry &entities, TimerWheel &timers, default_random_engine &rand_generator){
+    // only the enemies woken this tick: pick a target, start moving once faded in, stop there, wait 120 ticks
+    for (int i = 0; i != int(timers.fired.size()); i++){
+        Timer timer = timers.fired[i];
+        if (timer.kind == TIMER_SHOT || !entities.has<Wander>(timer.entity)){
+            continue;
+        }
+        Wander &wander = *entities.get<Wander>(timer.entity);
+        Velocity &velocity = *entities.get<Velocity>(timer.entity);
+
+        if (timer.kind == TIMER_WANDER_MOVE && wander.move_tick == timer.tick && Sint32(wander.arrive_tick - timer.tick) > 0){
+            velocity.x = wander.x_vel * wander.speed;
+            velocity.y = wander.y_vel * wander.speed;
+        } else if (timer.kind == TIMER_WANDER_ARRIVE && wander.arrive_tick == timer.tick){
+            velocity.x = 0;
+            velocity.y = 0;
+        } else if (timer.kind == TIMER_WANDER_RETARGET && wander.next_move_tick == timer.tick){
+            Position &position = *entities.get<Position>(timer.entity);
+            Size &size = *entities.get<Size>(timer.entity);
+            Sprite &sprite = *entities.get<Sprite>(timer.entity);
+
+            // random target
+            uniform_int_distribution<int> x_coord_dist(int(0 + size.width / 2), int(600 - size.width / 2));
+            uniform_int_distribution<int> y_coord_dist(int(0 + size.height / 2), int(500 - size.height / 2)); // don't go too close to the bottom
+            int x_target = x_coord_dist(rand_generator);
+            int y_target = y_coord_dist(rand_generator);
+
+            // get velocities
+            int targ_angle = angleTo(position.x, position.y, x_target, y_target);
+            wander.x_vel = sinDegrees(targ_angle);
+            wander.y_vel = cosDegrees(targ_angle);
+
+            // a pixel a tick, still fading in counts towards it
+            int dist_to_target = int(distance(position.x, position.y, x_target, y_target));
+            wander.arrive_tick = timer.tick + dist_to_target;
+            wander.next_move_tick = wander.arrive_tick + 120;
+            wander.move_tick = timer.tick;
+            if (sprite.alpha != 255 && entities.has<FadeIn>(timer.entity)){
+                int speed = max(entities.get<FadeIn>(timer.entity) -> speed, 1);
+                wander.move_tick += (255 - sprite.alpha + speed - 1) / speed;
+            }
+
+            velocity.x = 0;
+            velocity.y = 0;
+            scheduleWanderTimers(timers, timer.entity, wander);
+        }
+    }
+}
+
+void shooterSystem(EntityRegistry &entities, TimerWheel &timers){
+    // only the enemies whose cooldown is up this tick
+    for (int i = 0; i != int(timers.fired.size()); i++){
+        Timer timer = timers.fired[i];
+        if (timer.kind != TIMER_SHOT || !entities.has<Shooter>(timer.entity)){
+            continue;
+        }
+        Shooter &shooter = *entities.get<Shooter>(timer.entity);
+        if (shooter.next_shot_tick != timer.tick){
+            continue;
+        }
+
+        Position &position = *entities.get<Position>(timer.entity);
+        SDL_Rect rect = entityRect(position, *entities.get<Size>(timer.entity));
+        for (int shot = 0; shot != shooter.shot_num; shot++){
+            shooter.rotation += shooter.rotation_vel;
+            Scalar attack_xvel = sinDegrees(int(shooter.rotation)) * shooter.xvel_mult;
+            Scalar attack_yvel = cosDegrees(int(shooter.rotation)) * shooter.yvel_mult;
+            Entity attack = createEnemyShot(entities, {shooter.attack_clip, timer.tick}, position.x, rect.y + rect.h, shooter.attack_width, shooter.attack_height, shooter.attack_damage, attack_xvel, attack_yvel, timer.tick);
+            timers.schedule(attack, TIMER_TRAJECTORY_EXIT, entities.get<Trajectory>(attack) -> exit_tick);
+        }
+        shooter.next_shot_tick = timer.tick + max(shooter.cooldown, 1);
+        timers.schedule(timer.entity, TIMER_SHOT, shooter.next_shot_tick);
+    }
+}
+
+void trajectoryExitSystem(EntityRegistry &entities, TimerWheel &timers){
+    // only the bullets that have left the screen this tick
+    for (int i = 0; i != int(timers.fired.size()); i++){
+        Timer timer = timers.fired[i];
+        if (timer.kind == TIMER_TRAJECTORY_EXIT && entities.has<Trajectory>(timer.entity) && entities.get<Trajectory>(timer.entity) -> exit_tick == timer.tick){
+            entities.destroy(timer.entity);
+        }
+    }
+}
+
+void scheduleEnemyTimers(EntityRegistry &entities, TimerWheel &timers){
+    // every enemy's (and enemy attack's) wake-ups again (after loading). ones that have already happened fire
+    // with the current tick's timers, which advancing to the next tick throws away
+    entities.each<Wander, Shooter>([&](Entity entity, Wander &wander, Shooter &shooter){
+        timers.schedule(entity, TIMER_SHOT, shooter.next_shot_tick);
+        scheduleWanderTimers(timers, entity, wander);
+    });
+    entities.each<Trajectory>([&](Entity entity, Trajectory &trajectory){
+        timers.schedule(entity, TIMER_TRAJECTORY_EXIT, trajectory.exit_tick);
+    });
+}
+
+void glowSystem(EntityRegistry &entities){
+    entities.each<Glow>([&](Entity entity, Glow &glow){
+        // pulse
+        glow.radius += 0.2f * glow.direction;
+        glow.direction *= -1 + 2 * !(glow.radius <= glow.min || glow.radius >= glow.max);
+    });
+}
+
+void glowRenderSystem(EntityRegistry &entities, Bloom &bloom, bool bloom_enabled, vector<pair<SDL_Rect, int>> &glow_locs, int quality, long long tick){
+    auto addGlow = [&](Position position, Sprite &sprite, Glow &glow){
+        // into the bloom buffer, or as a glow sprite later
+        if (quality >= glow.quality && bloom_enabled){
+            bloom.addGlow(float(position.x), float(position.y), glow.radius, sprite.alpha);
+        } else if (quality >= glow.quality){
+            SDL_Rect glow_rect = {int(position.x), int(position.y), int(glow.radius), int(glow.radius)};
+            centerRect(glow_rect);
+            glow_locs.push_back({glow_rect, sprite.alpha});
+        }
+    };
+    entities.each<Position, Sprite, Glow>([&](Entity entity, Position &position, Sprite &sprite, Glow &glow){
+        addGlow(position, sprite, glow);
+    });
+
+    // drawn after tick has moved everything, so where they are at the start of the next one
+    entities.each<Trajectory, Sprite, Glow>([&](Entity entity, Trajectory &trajectory, Sprite &sprite, Glow &glow){
+        addGlow(trajectoryPosition(trajectory, tick + 1), sprite, glow);
+    });
+}
+
+void expireSystem(EntityRegistry &entities, AnimationClips &animation_clips, long long tick){
+    entities.each<Sprite, OneShot>([&](Entity entity, Sprite &sprite, OneShot &one_shot){
+        if (animation_clips.finished(sprite.animation, tick)){
+            entities.destroy(entity);
+        }
+    });
+}
+
+void renderSystem(EntityRegistry &entities, RenderBackend &render, Camera &camera, AnimationClips &animation_clips, long long tick, int layer){
+    auto draw = [&](Position position, Size &size, Sprite &sprite){
+        if (sprite.layer != layer){
+            return;
+        }
+        SDL_Rect rect = entityRect(position, size);
+        SDL_Texture *texture = animation_clips.frame(sprite.animation, tick);
+        render.setAlpha(texture, sprite.alpha);
+        camera.renderCopy(render, texture, NULL, &rect);
+    };
+    entities.each<Position, Size, Sprite>([&](Entity entity, Position &position, Size &size, Sprite &sprite){
+        draw(position, size, sprite);
+    });
+
+    // where they are at the start of the next tick, like everything that's been moved this one
+    entities.each<Trajectory, Size, Sprite>([&](Entity entity, Trajectory &trajectory, Size &size, Sprite &sprite){
+        draw(trajectoryPosition(trajectory, tick + 1), size, sprite);
+    });
+}
+
+void retuneEnemiesSystem(EntityRegistry &entities, TimerWheel &timers, Uint32 tick, unordered_map<string, unordered_map<string, float>> &enemy_data, vector<string> &enemy_types){
+    // after the config was reloaded (between ticks), enemies that are already alive pick up the new values too
+    entities.each<Velocity, Wander, Shooter, EnemyInfo>([&](Entity entity, Velocity &velocity, Wander &wander, Shooter &shooter, EnemyInfo &info){
+        unordered_map<string, float> &data = enemy_data[enemy_types[info.type]];
+        wander.speed = data["speed"];
+        shooter.rotation_vel = data["attack_rotation_vel"];
+        shooter.xvel_mult = data["attack_xvel_mult"];
+        shooter.yvel_mult = data["attack_yvel_mult"];
+        shooter.shot_num = data["shot_num"];
+        shooter.cooldown = data["shot_cooldown"];
+
+        // next shot no further off than the new cooldown, moving ones change speed straight away
+        Uint32 latest_shot_tick = tick + 1 + max(shooter.cooldown, 1);
+        if (Sint32(shooter.next_shot_tick - latest_shot_tick) > 0){
+            shooter.next_shot_tick = latest_shot_tick;
+            timers.schedule(entity, TIMER_SHOT, latest_shot_tick);
+        }
+        if (Sint32(tick - wander.move_tick) >= 0 && Sint32(wander.arrive_tick - tick) > 1){
+            velocity.x = wander.x_vel * wander.speed;
+            velocity.y = wander.y_vel * wander.speed;
+        }
+        shooter.attack_width = data["attack_width"];
+        shooter.attack_height = data["attack_height"];
+        shooter.attack_damage = data["attack_damage"];
+    });
+}
@@ -0,0 +1,135 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <windows.h>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "telemetry.hpp"
+
+using namespace std;
+
+// attaches to a running game's telemetry ring (see telemetry.hpp) and plots the last few seconds of it.
+// one strip per counter, scaled to the highest value on screen, newest frame on the right.
+// the latest values are in the window title. keeps waiting / reattaching while no game is running.
+
+const int VIEWER_WIDTH = 960;
+const int STRIP_HEIGHT = 64;
+const int HISTORY_FRAMES = VIEWER_WIDTH;
+
+struct Strip{
+    const char *name;
+    Uint8 r, g, b;
+    float (*value)(const TelemetryFrame &frame);
+};
+
+const Strip STRIPS[] = {
+    {"frame ms", 255, 255, 255, [](const TelemetryFrame &frame){ return frame.frame_ms; }},
+    {"entities", 120, 200, 255, [](const TelemetryFrame &frame){ return float(frame.entities); }},
+    {"enemies", 255, 120, 120, [](const TelemetryFrame &frame){ return float(frame.enemies); }},
+    {"enemy attacks", 255, 80, 200, [](const TelemetryFrame &frame){ return float(frame.enemy_attacks); }},
+    {"missiles", 255, 200, 80, [](const TelemetryFrame &frame){ return float(frame.missiles); }},
+    {"particles", 200, 160, 255, [](const TelemetryFrame &frame){ return float(frame.particles); }},
+    {"explosions", 255, 160, 60, [](const TelemetryFrame &frame){ return float(frame.explosions); }},
+    {"draw calls", 120, 255, 120, [](const TelemetryFrame &frame){ return float(frame.draw_calls); }},
+    {"texture switches", 60, 200, 120, [](const TelemetryFrame &frame){ return float(frame.texture_switches); }},
+    {"texture kb", 120, 160, 255, [](const TelemetryFrame &frame){ return float(frame.texture_kb); }},
+    {"audio calls", 255, 255, 120, [](const TelemetryFrame &frame){ return float(frame.audio_calls); }},
+    {"audio voices", 200, 255, 160, [](const TelemetryFrame &frame){ return float(frame.audio_voices); }},
+    {"audio underruns", 255, 60, 60, [](const TelemetryFrame &frame){ return float(frame.audio_underruns); }},
+    {"allocations", 255, 100, 60, [](const TelemetryFrame &frame){ return float(frame.allocations); }},
+    {"allocated kb", 255, 140, 100, [](const TelemetryFrame &frame){ return frame.allocation_bytes / 1024.0f; }},
+};
+const int STRIP_COUNT = sizeof(STRIPS) / sizeof(STRIPS[0]);
+
+string titleText(const TelemetryFrame &frame){
+    ostringstream text;
+    text.precision(3);
+    text << "frame " << frame.frame << " | ";
+    for (int i = 0; i != STRIP_COUNT; i++){
+        text << STRIPS[i].name << " " << STRIPS[i].value(frame) << (i + 1 == STRIP_COUNT ? "" : " | ");
+    }
+    return text.str();
+}
+
+int main(int argc, char* argv[]){
+
+    SDL_Init(SDL_INIT_VIDEO);
+    SDL_Window *window = SDL_CreateWindow("telemetry - waiting for game", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, VIEWER_WIDTH, STRIP_HEIGHT * STRIP_COUNT, 0);
+    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+
+    TelemetryReader reader;
+    vector<TelemetryFrame> history;
+    vector<SDL_Point> points(HISTORY_FRAMES);
+    Uint32 last_attach = 0;
+    Uint32 last_title = 0;
+
+    bool running = true;
+    while (running){
+        SDL_Event event;
+        while (SDL_PollEvent(&event) != 0){
+            if (event.type == SDL_QUIT){
+                running = false;
+            }
+        }
+
+        // (re)attach once a second while there's no game
+        if (reader.ring == NULL && SDL_GetTicks() - last_attach > 1000){
+            last_attach = SDL_GetTicks();
+            if (reader.open(TELEMETRY_MAPPING)){
+                history.clear();
+            }
+        }
+
+        reader.read(history);
+        if (int(history.size()) > HISTORY_FRAMES){
+            history.erase(history.begin(), history.end() - HISTORY_FRAMES);
+        }
+
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+
+        for (int strip = 0; strip != STRIP_COUNT; strip++){
+            int top = strip * STRIP_HEIGHT;
+
+            // separator
+            SDL_SetRenderDrawColor(renderer, 40, 40, 40, 255);
+            SDL_RenderDrawLine(renderer, 0, top, VIEWER_WIDTH, top);
+
+            if (history.empty()){
+                continue;
+            }
+
+            float highest = 1;
+            for (TelemetryFrame &frame : history){
+                highest = max(highest, STRIPS[strip].value(frame));
+            }
+
+            int x = VIEWER_WIDTH - history.size();
+            for (size_t i = 0; i != history.size(); i++){
+                float value = STRIPS[strip].value(history[i]);
+                points[i] = {x + int(i), top + STRIP_HEIGHT - 2 - int(value / highest * (STRIP_HEIGHT - 4))};
+            }
+            SDL_SetRenderDrawColor(renderer, STRIPS[strip].r, STRIPS[strip].g, STRIPS[strip].b, 255);
+            SDL_RenderDrawLines(renderer, points.data(), history.size());
+        }
+
+        SDL_RenderPresent(renderer);
+
+        // titles are slow on some window managers, a few times a second is enough
+        if (!history.empty() && SDL_GetTicks() - last_title > 250){
+            last_title = SDL_GetTicks();
+            SDL_SetWindowTitle(window, titleText(history.back()).c_str());
+        }
+
+        SDL_Delay(16);
+    }
+
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return 0;
+}
+
+// g++ telemetry-viewer.cpp -O2 -I"SDL2/include" -L"SDL2/lib" -Wall -lmingw32 -lSDL2main -lSDL2 -o telemetry-viewer
@@ -0,0 +1,261 @@
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <windows.h>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "ecs.hpp"
+#include "components.hpp"
+#include "render-backend.hpp"
+#include "audio.hpp"
+#include "alloc-tracker.hpp"
+
+using namespace std;
+
+#pragma once
+
+// per frame counters written into a ring in shared memory, so telemetry-viewer.cpp (or anything else that
+// opens the mapping) can watch a running game without the game printing anything.
+//
+// one writer (the game), any number of readers, no locks. the writer fills a slot and then bumps
+// frames_written. a reader copies the slots it hasn't seen, reads frames_written again, and drops
+// anything the writer could have been writing over while it copied.
+
+const char *TELEMETRY_MAPPING = "Local\\OverwhelmingTelemetry";
+const Uint32 TELEMETRY_MAGIC = 0x4D4C4554;
+const Uint32 TELEMETRY_VERSION = 4;
+const int TELEMETRY_FRAMES = 1024;
+
+struct TelemetryFrame{
+    Uint64 frame;
+    float frame_ms; // update + render + present, not the sleep after
+    Uint32 entities;
+    Uint32 enemies;
+    Uint32 enemy_attacks;
+    Uint32 missiles;
+    Uint32 particles;
+    Uint32 explosions;
+    Uint32 draw_calls;
+    Uint32 texture_switches;
+    Uint32 textures; // alive
+    Uint32 texture_kb;
+    Uint32 audio_calls;
+    Uint32 audio_voices;
+    Uint32 audio_underruns; // since the game started
+    Uint32 allocations;
+    Uint32 allocation_bytes;
+};
+
+struct TelemetryRing{
+    Uint32 magic;
+    Uint32 version;
+    Uint32 frame_bytes; // so a viewer built against a different TelemetryFrame notices
+    Uint32 capacity;
+    atomic<Uint64> frames_written;
+    TelemetryFrame frames[TELEMETRY_FRAMES];
+};
+
+// every operator new in the process is counted (only include this from one translation unit), and with
+// ALLOC_TRACKING handed to alloc_tracker as well (see alloc-tracker.hpp)
+atomic<Uint32> telemetry_allocations(0);
+atomic<Uint32> telemetry_allocation_bytes(0);
+
+void* operator new(size_t size){
+    telemetry_allocations.fetch_add(1, memory_order_relaxed);
+    telemetry_allocation_bytes.fetch_add(size, memory_order_relaxed);
+    if (ALLOC_TRACKING_ENABLED){
+        alloc_tracker.allocated(size);
+    }
+    void *memory = malloc(size == 0 ? 1 : size);
+    if (memory == NULL){
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t size){
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept{
+    if (ALLOC_TRACKING_ENABLED && memory != NULL){
+        alloc_tracker.freed();
+    }
+    free(memory);
+}
+
+void operator delete[](void *memory) noexcept{
+    operator delete(memory);
+}
+
+void operator delete(void *memory, size_t size) noexcept{
+    if (ALLOC_TRACKING_ENABLED && memory != NULL){
+        alloc_tracker.freed();
+    }
+    free(memory);
+}
+
+void operator delete[](void *memory, size_t size) noexcept{
+    operator delete(memory, size);
+}
+
+class TelemetryWriter{
+    public:
+        HANDLE mapping = NULL;
+        TelemetryRing *ring = NULL;
+        Uint64 frame = 0;
+        Uint32 allocations_before = 0;
+        Uint32 allocation_bytes_before = 0;
+
+        // methods
+        TelemetryWriter(const char *name);
+        ~TelemetryWriter();
+        void write(EntityRegistry &entities, RenderBackend &render, AudioBackend &audio, float frame_ms);
+
+        TelemetryWriter(const TelemetryWriter&) = delete;
+        TelemetryWriter& operator=(const TelemetryWriter&) = delete;
+};
+
+TelemetryWriter::TelemetryWriter(const char *name){
+    mapping = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(TelemetryRing), name);
+    if (mapping == NULL){
+        cout << "Couldn't create telemetry mapping " << name << "\n";
+        return;
+    }
+    ring = (TelemetryRing*)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TelemetryRing));
+    if (ring == NULL){
+        cout << "Couldn't map telemetry mapping " << name << "\n";
+        return;
+    }
+
+    // readers that are still attached from a previous run start over
+    ring -> frames_written.store(0, memory_order_release);
+    ring -> version = TELEMETRY_VERSION;
+    ring -> frame_bytes = sizeof(TelemetryFrame);
+    ring -> capacity = TELEMETRY_FRAMES;
+    ring -> magic = TELEMETRY_MAGIC;
+}
+
+TelemetryWriter::~TelemetryWriter(){
+    if (ring != NULL){
+        UnmapViewOfFile(ring);
+    }
+    if (mapping != NULL){
+        CloseHandle(mapping);
+    }
+}
+
+void TelemetryWriter::write(EntityRegistry &entities, RenderBackend &render, AudioBackend &audio, float frame_ms){
+    Uint32 allocations = telemetry_allocations.load(memory_order_relaxed);
+    Uint32 allocation_bytes = telemetry_allocation_bytes.load(memory_order_relaxed);
+
+    if (ring != NULL){
+        TelemetryFrame &slot = ring -> frames[frame % TELEMETRY_FRAMES];
+        slot.frame = frame;
+        slot.frame_ms = frame_ms;
+        slot.entities = entities.entity_count;
+        slot.enemies = entities.count<EnemyInfo>();
+        slot.enemy_attacks = entities.count<EnemyShot>();
+        slot.missiles = entities.count<PlayerShot>();
+        slot.particles = entities.count<Fade>();
+        slot.explosions = entities.count<OneShot>();
+        slot.draw_calls = render.draw_calls;
+        slot.texture_switches = render.texture_switches;
+        slot.textures = render.texture_count;
+        slot.texture_kb = render.texture_bytes / 1024;
+        slot.audio_calls = audio.play_calls;
+        slot.audio_voices = audio.activeVoices();
+        slot.audio_underruns = audio.underruns();
+        slot.allocations = allocations - allocations_before;
+        slot.allocation_bytes = allocation_bytes - allocation_bytes_before;
+        ring -> frames_written.store(frame + 1, memory_order_release);
+    }
+
+    frame += 1;
+    allocations_before = allocations;
+    allocation_bytes_before = allocation_bytes;
+    render.resetCounters();
+    audio.play_calls = 0;
+}
+
+class TelemetryReader{
+    public:
+        HANDLE mapping = NULL;
+        TelemetryRing *ring = NULL;
+        Uint64 next_frame = 0;
+
+        // methods
+        ~TelemetryReader();
+        bool open(const char *name);
+        void close();
+        void read(vector<TelemetryFrame> &frames);
+};
+
+TelemetryReader::~TelemetryReader(){
+    close();
+}
+
+bool TelemetryReader::open(const char *name){
+    close();
+    // mapped writable, 32 bit builds load 64 bit atomics with a compare exchange
+    mapping = OpenFileMapping(FILE_MAP_ALL_ACCESS, FALSE, name);
+    if (mapping == NULL){
+        return false;
+    }
+    ring = (TelemetryRing*)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TelemetryRing));
+    if (ring == NULL || ring -> magic != TELEMETRY_MAGIC || ring -> version != TELEMETRY_VERSION || ring -> frame_bytes != sizeof(TelemetryFrame)){
+        close();
+        return false;
+    }
+    next_frame = 0;
+    return true;
+}
+
+void TelemetryReader::close(){
+    if (ring != NULL){
+        UnmapViewOfFile(ring);
+        ring = NULL;
+    }
+    if (mapping != NULL){
+        CloseHandle(mapping);
+        mapping = NULL;
+    }
+}
+
+void TelemetryReader::read(vector<TelemetryFrame> &frames){
+    // appends every frame written since the last read (that is still in the ring)
+    if (ring == NULL){
+        return;
+    }
+
+    Uint64 written = ring -> frames_written.load(memory_order_acquire);
+    if (written < next_frame){ // game restarted
+        next_frame = 0;
+    }
+    if (written - next_frame > TELEMETRY_FRAMES){
+        next_frame = written - TELEMETRY_FRAMES;
+    }
+
+    size_t start = frames.size();
+    Uint64 first_frame = next_frame;
+    for (Uint64 i = next_frame; i != written; i++){
+        frames.push_back(ring -> frames[i % TELEMETRY_FRAMES]);
+    }
+    next_frame = written;
+
+    // the writer could have lapped the oldest of those, and be partway through the slot after the
+    // newest one it has published
+    atomic_thread_fence(memory_order_acquire);
+    Uint64 written_after = ring -> frames_written.load(memory_order_relaxed);
+    Uint64 oldest_safe = (written_after + 1 > TELEMETRY_FRAMES) ? written_after + 1 - TELEMETRY_FRAMES : 0;
+    size_t keep = start;
+    for (size_t i = start; i != frames.size(); i++){
+        Uint64 expected = first_frame + (i - start);
+        if (expected >= oldest_safe && frames[i].frame == expected){
+            frames[keep++] = frames[i];
+        }
+    }
+    frames.resize(keep);
+}
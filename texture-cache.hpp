@@ -0,0 +1,277 @@
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <algorithm>
+#include "SDL2/include/SDL2/SDL.h"
+#include "SDL2/include/SDL2/SDL_image.h"
+
+#include "render-backend.hpp"
+
+using namespace std;
+
+#pragma once
+
+// textures shared by path. acquire() loads a path once and hands out TextureRefs to it. the refs count
+// themselves: copying one adds a user, destroying or overwriting one takes it away. so an object that is
+// rebuilt (player = Player(...)) gets the same texture again instead of loading another copy.
+//
+// a texture nothing uses stays loaded in case it's wanted again, until the textures kept go over the
+// budget: then the ones that have been unused longest are destroyed. textures still in use are never
+// destroyed, even over budget. everything left is destroyed with the cache.
+//
+// prefetch() decodes images on a background thread ahead of when they're needed. the renderer can only be
+// used from the thread that made it, so pump() (on the render thread) turns decoded images into textures, a
+// few at a time, and keeps them as unused textures. acquiring one after that is a lookup. acquiring one
+// that hasn't been decoded yet loads it on the spot.
+
+const Uint64 TEXTURE_CACHE_BUDGET = 64 * 1024 * 1024;
+const int TEXTURE_PUMP_MAX = 4; // textures made from prefetched images per pump
+const int TEXTURE_PUMP_ALL = -1;
+
+class TextureCache;
+
+class TextureRef{
+    public:
+        TextureCache *cache = NULL;
+        SDL_Texture *texture = NULL;
+
+        // methods
+        TextureRef(){}
+        TextureRef(TextureCache *cache_, SDL_Texture *texture_);
+        TextureRef(const TextureRef &other);
+        TextureRef& operator=(const TextureRef &other);
+        ~TextureRef();
+
+        operator SDL_Texture*() const { return texture; }
+};
+
+struct CachedTexture{
+    SDL_Texture *texture;
+    Uint64 bytes;
+    int references = 0;
+    Uint64 last_released = 0; // release counter when references got to 0
+};
+
+class TextureCache{
+    public:
+        RenderBackend &render;
+        Uint64 budget;
+
+        unordered_map<string, CachedTexture> entries;
+        unordered_map<SDL_Texture*, string> paths;
+        Uint64 resident_bytes = 0;
+        Uint64 releases = 0;
+
+        // prefetching (queue and decoded are shared with the thread)
+        thread prefetch_thread;
+        mutex prefetch_mutex;
+        vector<string> prefetch_queue;
+        vector<pair<string, SDL_Surface*>> decoded;
+        bool prefetching = false;
+
+        // methods
+        TextureCache(RenderBackend &render_, Uint64 budget_);
+        ~TextureCache();
+        TextureRef acquire(string path);
+        void retain(SDL_Texture *texture);
+        void release(SDL_Texture *texture);
+        void trim();
+        void prefetch(const vector<string> &paths);
+        void pump(int max_textures);
+        void add(string path, SDL_Texture *texture);
+        void decodeQueued();
+
+        TextureCache(const TextureCache&) = delete;
+        TextureCache& operator=(const TextureCache&) = delete;
+};
+
+TextureRef::TextureRef(TextureCache *cache_, SDL_Texture *texture_){
+    // already counted by acquire
+    cache = cache_;
+    texture = texture_;
+}
+
+TextureRef::TextureRef(const TextureRef &other){
+    cache = other.cache;
+    texture = other.texture;
+    if (texture != NULL){
+        cache -> retain(texture);
+    }
+}
+
+TextureRef& TextureRef::operator=(const TextureRef &other){
+    // retain first, other may be the only thing keeping it alive
+    if (other.texture != NULL){
+        other.cache -> retain(other.texture);
+    }
+    if (texture != NULL){
+        cache -> release(texture);
+    }
+    cache = other.cache;
+    texture = other.texture;
+    return *this;
+}
+
+TextureRef::~TextureRef(){
+    if (texture != NULL){
+        cache -> release(texture);
+    }
+}
+
+TextureCache::TextureCache(RenderBackend &render_, Uint64 budget_ = TEXTURE_CACHE_BUDGET) : render(render_){
+    budget = budget_;
+}
+
+TextureCache::~TextureCache(){
+    // let the thread finish what it's decoding
+    {
+        lock_guard<mutex> lock(prefetch_mutex);
+        prefetch_queue.clear();
+    }
+    if (prefetch_thread.joinable()){
+        prefetch_thread.join();
+    }
+    for (auto &[path, surface] : decoded){
+        SDL_FreeSurface(surface);
+    }
+
+    for (auto &[path, entry] : entries){
+        render.destroyTexture(entry.texture);
+    }
+}
+
+void TextureCache::add(string path, SDL_Texture *texture){
+    int width, height;
+    render.queryTexture(texture, &width, &height);
+    CachedTexture entry;
+    entry.texture = texture;
+    entry.bytes = Uint64(width) * height * 4;
+    entries.emplace(path, entry);
+    paths[texture] = path;
+    resident_bytes += entry.bytes;
+}
+
+TextureRef TextureCache::acquire(string path){
+    auto found = entries.find(path);
+    if (found == entries.end()){
+        pump(TEXTURE_PUMP_ALL);
+        found = entries.find(path);
+    }
+    if (found == entries.end()){
+        SDL_Texture *texture = render.loadTexture(path.c_str());
+        if (texture == NULL){
+            return TextureRef();
+        }
+        add(path, texture);
+        found = entries.find(path);
+    }
+
+    found -> second.references += 1;
+    TextureRef ref(this, found -> second.texture);
+    trim();
+    return ref;
+}
+
+void TextureCache::retain(SDL_Texture *texture){
+    entries[paths[texture]].references += 1;
+}
+
+void TextureCache::release(SDL_Texture *texture){
+    CachedTexture &entry = entries[paths[texture]];
+    entry.references -= 1;
+    if (entry.references == 0){
+        releases += 1;
+        entry.last_released = releases;
+        trim();
+    }
+}
+
+void TextureCache::trim(){
+    // unused textures, longest unused first, until under budget
+    while (resident_bytes > budget){
+        auto oldest = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); it++){
+            if (it -> second.references == 0 && (oldest == entries.end() || it -> second.last_released < oldest -> second.last_released)){
+                oldest = it;
+            }
+        }
+        if (oldest == entries.end()){
+            return;
+        }
+
+        resident_bytes -= oldest -> second.bytes;
+        paths.erase(oldest -> second.texture);
+        render.destroyTexture(oldest -> second.texture);
+        entries.erase(oldest);
+    }
+}
+
+void TextureCache::prefetch(const vector<string> &paths){
+    lock_guard<mutex> lock(prefetch_mutex);
+    for (const string &path : paths){
+        if (entries.find(path) == entries.end() && find(prefetch_queue.begin(), prefetch_queue.end(), path) == prefetch_queue.end()){
+            prefetch_queue.push_back(path);
+        }
+    }
+
+    // the thread stops once the queue is empty, start another if it has
+    if (!prefetching && !prefetch_queue.empty()){
+        if (prefetch_thread.joinable()){
+            prefetch_thread.join();
+        }
+        prefetching = true;
+        prefetch_thread = thread(&TextureCache::decodeQueued, this);
+    }
+}
+
+void TextureCache::decodeQueued(){
+    // prefetch thread
+    while (true){
+        string path;
+        {
+            lock_guard<mutex> lock(prefetch_mutex);
+            if (prefetch_queue.empty()){
+                prefetching = false;
+                return;
+            }
+            path = prefetch_queue.front();
+            prefetch_queue.erase(prefetch_queue.begin());
+        }
+
+        SDL_Surface *surface = IMG_Load(path.c_str());
+        if (surface == NULL){
+            cout << "Unable to load image: " << path << "\n";
+            continue;
+        }
+
+        lock_guard<mutex> lock(prefetch_mutex);
+        decoded.push_back({path, surface});
+    }
+}
+
+void TextureCache::pump(int max_textures){
+    vector<pair<string, SDL_Surface*>> ready;
+    {
+        lock_guard<mutex> lock(prefetch_mutex);
+        int count = (max_textures == TEXTURE_PUMP_ALL) ? decoded.size() : min(int(decoded.size()), max_textures);
+        ready.assign(decoded.begin(), decoded.begin() + count);
+        decoded.erase(decoded.begin(), decoded.begin() + count);
+    }
+
+    // kept as unused until something acquires them (skipped if one was loaded on the spot meanwhile)
+    for (auto &[path, surface] : ready){
+        if (entries.find(path) == entries.end()){
+            SDL_Texture *texture = render.textureFromSurface(surface);
+            if (texture != NULL){
+                add(path, texture);
+                releases += 1;
+                entries[path].last_released = releases;
+            }
+        }
+        SDL_FreeSurface(surface);
+    }
+    trim();
+}
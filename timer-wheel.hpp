@@ -0,0 +1,132 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "ecs.hpp"
+
+using namespace std;
+
+#pragma once
+
+// wake-ups for entities at a given tick, so only the entities that have something to do that tick are
+// touched (instead of every entity counting down every tick).
+//
+// hierarchical: 4 levels of 256 slots, level n slots are 256^n ticks wide. a timer goes in the level of
+// the highest byte its tick differs from now in, and drops down a level each time now reaches its slot.
+// advancing a tick only looks at one slot (plus one more every 256 ticks), however many timers there are.
+//
+// timers aren't cancelled: the component keeps the tick it wants waking at, and a timer that fires for a
+// tick the component no longer wants (or for an entity that's gone) is skipped by whoever handles it.
+// rescheduling is just scheduling again. timers aren't saved either, the world schedules them again from
+// its components after loading. that fills the wheel in a different order, so each tick's timers are
+// sorted by entity before they're handed out: handlers create and destroy entities in that order, and a
+// loaded world has to end up with the same rows as the one it was saved from.
+
+const int TIMER_WHEEL_LEVELS = 4;
+const int TIMER_WHEEL_SLOTS = 256;
+const int TIMER_WHEEL_BITS = 8;
+
+enum TimerKind{
+    TIMER_SHOT,
+    TIMER_WANDER_MOVE,
+    TIMER_WANDER_ARRIVE,
+    TIMER_WANDER_RETARGET,
+    TIMER_TRAJECTORY_EXIT,
+};
+
+struct Timer{
+    Entity entity;
+    Uint32 tick;
+    int kind;
+};
+
+class TimerWheel{
+    public:
+        Uint32 now = 0; // last tick advanced to
+        vector<Timer> slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+        int scheduled = 0;
+
+        // timers for now, handlers go through them by index (scheduling for now adds to the end)
+        vector<Timer> fired;
+
+        // methods
+        void schedule(Entity entity, int kind, Uint32 tick);
+        void advance(Uint32 tick);
+        void clear(Uint32 tick);
+        void place(const Timer &timer);
+};
+
+void TimerWheel::place(const Timer &timer){
+    // level of the highest byte that differs from now
+    Uint32 differs = timer.tick ^ now;
+    int level = 0;
+    while (level + 1 != TIMER_WHEEL_LEVELS && (differs >> (TIMER_WHEEL_BITS * (level + 1)))){
+        level += 1;
+    }
+    slots[level][(timer.tick >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1)].push_back(timer);
+}
+
+void TimerWheel::schedule(Entity entity, int kind, Uint32 tick){
+    // now or earlier fires with now's timers (if they haven't been handled yet)
+    Timer timer = {entity, tick, kind};
+    if (Sint32(tick - now) <= 0){
+        timer.tick = now;
+        fired.push_back(timer);
+        return;
+    }
+    place(timer);
+    scheduled += 1;
+}
+
+void TimerWheel::advance(Uint32 tick){
+    fired.clear();
+
+    // nothing waiting, no need to step through the ticks in between
+    if (scheduled == 0){
+        now = tick;
+        return;
+    }
+
+    while (now != tick){
+        now += 1;
+
+        // moving into a new slot of a higher level: its timers drop down (highest level first)
+        for (int level = TIMER_WHEEL_LEVELS - 1; level != 0; level--){
+            if (now & ((Uint32(1) << (TIMER_WHEEL_BITS * level)) - 1)){
+                continue;
+            }
+            vector<Timer> &slot = slots[level][(now >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1)];
+            for (const Timer &timer : slot){
+                place(timer);
+            }
+            slot.clear();
+        }
+
+        vector<Timer> &slot = slots[0][now & (TIMER_WHEEL_SLOTS - 1)];
+        fired.insert(fired.end(), slot.begin(), slot.end());
+        scheduled -= slot.size();
+        slot.clear();
+    }
+
+    sort(fired.begin(), fired.end(), [](const Timer &a, const Timer &b){
+        if (a.entity.index != b.entity.index){
+            return a.entity.index < b.entity.index;
+        }
+        if (a.kind != b.kind){
+            return a.kind < b.kind;
+        }
+        return a.tick < b.tick;
+    });
+}
+
+void TimerWheel::clear(Uint32 tick){
+    for (int level = 0; level != TIMER_WHEEL_LEVELS; level++){
+        for (vector<Timer> &slot : slots[level]){
+            slot.clear();
+        }
+    }
+    fired.clear();
+    scheduled = 0;
+    now = tick;
+}
@@ -0,0 +1,1060 @@
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <random>
+#include <cmath>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include "SDL2/include/SDL2/SDL.h"
+
+#include "functions.hpp"
+#include "game-classes.hpp"
+#include "render-backend.hpp"
+#include "audio.hpp"
+#include "bloom.hpp"
+#include "hud-layer.hpp"
+#include "quality-governor.hpp"
+#include "animation.hpp"
+#include "ecs.hpp"
+#include "components.hpp"
+#include "systems.hpp"
+#include "timer-wheel.hpp"
+#include "config.hpp"
+
+using namespace std;
+
+#pragma once
+
+// one whole game: menu, waves, player, entities, camera and random generator.
+// a world only touches its own state, and draws / plays sounds through the backends it was given,
+// so any number of worlds can run in one process, each on its own thread (headless worlds use
+// NullRender and SilentAudio, only one world at a time should use the window's SDLRender or MixerAudio).
+//
+// update() moves the game forward one tick, render() draws the current state and changes nothing.
+
+// game states
+const int PLAYING = 1;
+const int MENU = 2;
+const int DEATH_SCREEN = 3;
+
+// input for one tick, filled from SDL events by the window or made up by a bot
+struct WorldInput{
+    bool quit = false;
+    vector<SDL_Keycode> pressed; // keys pressed down this tick
+
+    // held
+    bool left = false;
+    bool right = false;
+    bool up = false;
+    bool down = false;
+};
+
+class World{
+    public:
+        // backends
+        RenderBackend &render_backend;
+        AudioBackend &audio;
+
+        // every texture the world loads, shared by path (freed with the world)
+        TextureCache textures;
+        unordered_map<string, TextureRef> world_textures; // held for the world's lifetime
+
+        // textures each game state draws with. a state's set is loaded the first time the state is drawn
+        // (headless worlds never load any), and then the set of the state likely to come next is decoded in
+        // the background. clips and texture variables point at NULL until their state has been drawn.
+        unordered_map<int, vector<string>> state_textures;
+        unordered_map<int, bool> state_textures_loaded;
+        unordered_map<int, int> next_state = {
+            {MENU, PLAYING},
+            {PLAYING, DEATH_SCREEN},
+            {DEATH_SCREEN, MENU},
+        };
+
+        // texture paths
+        string missile_path = "assets/missile/missile.png";
+        vector<string> particle_paths = {
+            "assets/particle/red_circle.png",
+            "assets/particle/orange_circle.png",
+            "assets/particle/white_circle.png",
+            "assets/particle/green_circle.png", // used in enemy explosions
+        };
+        unordered_map<string, vector<string>> enemy_texture_paths = {
+            {"soldier", {"assets/soldier/frames/frame1.png", "assets/soldier/frames/frame2.png"}},
+            {"compass", {"assets/compass/frames/frame1.png"}},
+            {"shotgun", {"assets/shotgun/frames/frame1.png"}},
+            {"sprayer", {"assets/sprayer/frames/frame1.png"}},
+        };
+        unordered_map<string, vector<string>> enemy_attack_paths = {
+            {"soldier", {"assets/soldier/attacks/frame1.png"}},
+            {"compass", {"assets/compass/attacks/frame1.png"}},
+            {"shotgun", {"assets/shotgun/attacks/frame1.png"}},
+            {"sprayer", {"assets/sprayer/attacks/frame1.png"}},
+        };
+        vector<string> explosion_paths = {
+            "assets/hit/hit1.png",
+            "assets/hit/hit2.png",
+            "assets/hit/hit3.png",
+            "assets/hit/hit4.png",
+            "assets/hit/hit5.png",
+        };
+        string glow_path = "assets/glow/glow.png";
+        string background_path = "assets/background/background.jpg";
+        string selection_arrow_path = "assets/arrow/arrow.png";
+        string dim_path = "assets/dim/dim.png";
+        string death_transition_path = "assets/death/transition_background.png";
+
+        // game variables
+        bool running = true;
+        long long game_ticks = 0;
+        int game_state = MENU;
+
+        // random
+        default_random_engine rand_generator;
+
+        // camera shake
+        Camera camera;
+
+        // turns effects down when frames get slow, f3 to show levels
+        QualityGovernor quality_governor;
+
+        // font renderer
+        FontRenderer font_renderer;
+
+        // every missile, particle, enemy, enemy attack and explosion
+        EntityRegistry entities;
+
+        // enemies' next shot / move, only the ones due are looked at each tick
+        TimerWheel timers;
+
+        // animation clips, shared by all of them
+        AnimationClips animation_clips;
+
+        // missiles
+        Uint16 missile_clip;
+
+        // particles
+        vector<Uint16> particle_clips;
+
+        uniform_int_distribution<int> thruster_particle_angle = uniform_int_distribution<int>(115, 235);
+        uniform_int_distribution<int> thruster_particle_texture = uniform_int_distribution<int>(0, 2); // skip green texture
+        uniform_int_distribution<int> thruster_particle_size = uniform_int_distribution<int>(10, 20);
+        uniform_int_distribution<int> thruster_particle_mult = uniform_int_distribution<int>(100, 200);
+
+        uniform_int_distribution<int> death_particle_angle = uniform_int_distribution<int>(160, 200);
+        uniform_int_distribution<int> death_particle_size = uniform_int_distribution<int>(10, 20);
+        uniform_int_distribution<int> death_particle_mult = uniform_int_distribution<int>(500, 700);
+
+        // enemies (built in values, config/game.cfg overrides them)
+        ConfigSections enemy_data = {
+            {"soldier", {
+                {"speed", 1},
+                {"width", 80},
+                {"height", 94},
+                {"frame_delay_ticks", 10},
+                {"health", 500},
+                {"shot_cooldown", 40},
+                {"shot_num", 1},
+                {"attack_damage", 20},
+                {"attack_width", 20},
+                {"attack_height", 20},
+                {"attack_xvel_mult", 1},
+                {"attack_yvel_mult", 3},
+                {"attack_rotation_vel", 0},
+                {"attack_next_frame_ticks", 1},
+            }},
+            {"compass", {
+                {"speed", 0.5f},
+                {"width", 100},
+                {"height", 100},
+                {"frame_delay_ticks", 10},
+                {"health", 1000},
+                {"shot_cooldown", 90},
+                {"shot_num", 8},
+                {"attack_damage", 40},
+                {"attack_width", 20},
+                {"attack_height", 20},
+                {"attack_xvel_mult", 2},
+                {"attack_yvel_mult", 2},
+                {"attack_rotation_vel", 45},
+                {"attack_next_frame_ticks", 1},
+            }},
+            {"shotgun", {
+                {"speed", 0.5f},
+                {"width", 150},
+                {"height", 92},
+                {"frame_delay_ticks", 10},
+                {"health", 1500},
+                {"shot_cooldown", 70},
+                {"shot_num", 5},
+                {"attack_damage", 30},
+                {"attack_width", 20},
+                {"attack_height", 20},
+                {"attack_xvel_mult", 2},
+                {"attack_yvel_mult", 2},
+                {"attack_rotation_vel", 10},
+                {"attack_next_frame_ticks", 1},
+            }},
+            {"sprayer", {
+                {"speed", 0.7f},
+                {"width", 150},
+                {"height", 131},
+                {"frame_delay_ticks", 10},
+                {"health", 4000},
+                {"shot_cooldown", 2},
+                {"shot_num", 1},
+                {"attack_damage", 30},
+                {"attack_width", 20},
+                {"attack_height", 20},
+                {"attack_xvel_mult", 2},
+                {"attack_yvel_mult", 2},
+                {"attack_rotation_vel", 15},
+                {"attack_next_frame_ticks", 1},
+            }},
+        };
+
+        // waves and spawning (same file, [waves] section)
+        unordered_map<string, float> wave_data = {
+            {"start_max_enemies", 3},
+            {"enemies_per_wave", 1},
+            {"boss_every", 5},
+            {"spawn_ticks_min", 120},
+            {"spawn_ticks_max", 180},
+            {"next_wave_ticks", 240},
+        };
+
+        unordered_map<string, vector<SDL_Texture*>> enemy_textures;
+        unordered_map<string, vector<SDL_Texture*>> enemy_attacks;
+
+        unordered_map<string, bool> has_particles = {
+            {"soldier", true},
+            {"compass", true},
+            {"shotgun", true},
+            {"sprayer", false},
+        };
+
+        // enemy animation clips
+        unordered_map<string, Uint16> enemy_clips;
+        unordered_map<string, Uint16> attack_clips;
+
+        // enemy spawning
+        int max_enemies;
+        vector<string> choose_enemies = {
+            "soldier", "compass", "shotgun",
+        };
+        vector<string> choose_bosses = {
+            "sprayer",
+        };
+        vector<string> enemy_types = {
+            "soldier", "compass", "shotgun", "sprayer",
+        };
+        long long next_spawn_tick = 0; // tick the next spawn is tried on
+        int spawned_already = 0;
+        long long next_wave_tick = 0; // nothing spawns before this (the wave text)
+        uniform_int_distribution<int> rand_spawn_ticks;
+        uniform_int_distribution<int> rand_enemy_index;
+        uniform_int_distribution<int> rand_boss_index;
+
+        // waves
+        int wave = 1;
+
+        // explosions
+        Uint16 hit_explosion_clip;
+        Uint16 enemy_explosion_clip;
+        Uint16 player_explosion_clip;
+
+        // wave text
+        float wave_text_x = -300;
+        bool wave_start = true;
+
+        // fake glow
+        SDL_Texture* glow_vignette;
+        vector<pair<SDL_Rect, int>> glow_locs; // render all glows at once (faster?)
+
+        // bloom (one blurred low res pass instead of a glow sprite per bullet), b to toggle
+        Bloom bloom;
+        bool bloom_enabled = true;
+
+        // scrolling background
+        SDL_Texture* background_texture;
+        SDL_Rect background_1 = {-10, 0, 620, 700};
+        SDL_Rect background_2 = {-10, -700, 620, 700};
+
+        // healthbar
+        HealthBar health_bar;
+
+        // health bar, hp and wave text, only redrawn when they change
+        HudLayer hud;
+
+        // player
+        Player player;
+
+        // menu attacks
+        int new_attack_angle = 0;
+
+        // menu selections
+        unordered_map<string, unordered_map<string, int>> menu_selections = {
+            {"play", {
+                {"x", 300},
+                {"y", 350},
+                {"size", 50},
+            }},
+            {"options", {
+                {"x", 300},
+                {"y", 420},
+                {"size", 50},
+            }},
+            {"exit", {
+                {"x", 300},
+                {"y", 490},
+                {"size", 50},
+            }},
+        };
+
+        unordered_map<string, string> up_selections = {
+            {"exit", "options"},
+            {"options", "play"},
+            {"play", "play"},
+        };
+
+        unordered_map<string, string> down_selections = {
+            {"play", "options"},
+            {"options", "exit"},
+            {"exit", "exit"},
+        };
+
+        string menu_selected = "play";
+
+        // arrow next to current menu selection
+        SDL_Texture* selection_arrow_texture;
+        SDL_Rect selection_arrow_rect = {0, 0, 20, 24};
+
+        // menu dim
+        SDL_Texture* dim_texture;
+        SDL_Rect dim_rect = {-100, -100, 1000, 1000};
+
+        // player death explosion
+        Entity player_death_explosion;
+
+        // death black background
+        SDL_Texture *death_transition_background;
+        SDL_Rect death_transition_rect = {0, 0, 600, 700};
+        int death_transition_alpha = 0;
+
+        // methods
+        World(RenderBackend &render_backend_, AudioBackend &audio_, unsigned int seed, float frame_budget);
+        World(const World&) = delete;
+        World& operator=(const World&) = delete;
+
+        void applyConfig(ConfigSections &config);
+        void applyAnimationTiming();
+        void update(WorldInput &input);
+        void render();
+
+        void updateMenu(WorldInput &input);
+        void updateDeathScreen(WorldInput &input);
+        void updatePlaying(WorldInput &input);
+        void renderMenu();
+        void renderDeathScreen();
+        void renderPlaying();
+
+        void loadStateTextures();
+        void bindTextures();
+        SDL_Texture* texture(string path);
+        void spawnEnemy(string enemy_type, bool boss, float x, float y);
+        void scrollBackground();
+        void renderBackground();
+        void renderGlows();
+};
+
+World::World(RenderBackend &render_backend_, AudioBackend &audio_, unsigned int seed, float frame_budget) :
+    render_backend(render_backend_),
+    audio(audio_),
+    textures(render_backend_),
+    rand_generator(seed),
+    quality_governor(frame_budget),
+    font_renderer(render_backend_, "assets/font/font.ttf"),
+    bloom(render_backend_, 600, 700, 4),
+    health_bar("assets/healthbar/healthbar.jpg", 500, 50),
+    hud(render_backend_){
+
+    // what each state draws with (the player and health bar load their own, they're listed to be prefetched)
+    vector<string> &menu_textures = state_textures[MENU];
+    menu_textures = {background_path, selection_arrow_path, dim_path, glow_path};
+    menu_textures.insert(menu_textures.end(), enemy_attack_paths["soldier"].begin(), enemy_attack_paths["soldier"].end());
+
+    vector<string> &playing_textures = state_textures[PLAYING];
+    playing_textures = {background_path, dim_path, glow_path, death_transition_path, missile_path, health_bar.texture_path};
+    playing_textures.insert(playing_textures.end(), player.texture_paths.begin(), player.texture_paths.end());
+    playing_textures.insert(playing_textures.end(), particle_paths.begin(), particle_paths.end());
+    playing_textures.insert(playing_textures.end(), explosion_paths.begin(), explosion_paths.end());
+    for (string &type : enemy_types){
+        playing_textures.insert(playing_textures.end(), enemy_texture_paths[type].begin(), enemy_texture_paths[type].end());
+        playing_textures.insert(playing_textures.end(), enemy_attack_paths[type].begin(), enemy_attack_paths[type].end());
+    }
+
+    state_textures[DEATH_SCREEN] = {death_transition_path};
+
+    // clips with nothing loaded yet (their ids and lengths don't depend on textures)
+    bindTextures();
+
+    // enemy spawning
+    max_enemies = wave_data["start_max_enemies"];
+    rand_spawn_ticks = uniform_int_distribution<int>(wave_data["spawn_ticks_min"], wave_data["spawn_ticks_max"]);
+    rand_enemy_index = uniform_int_distribution<int>(0, choose_enemies.size() - 1);
+    rand_boss_index = uniform_int_distribution<int>(0, choose_bosses.size() - 1);
+}
+
+SDL_Texture* World::texture(string path){
+    auto found = world_textures.find(path);
+    return (found == world_textures.end()) ? NULL : (SDL_Texture*)found -> second;
+}
+
+void World::loadStateTextures(){
+    // the current state's textures (already made if they were prefetched), then the next state's in the background
+    if (!state_textures_loaded[game_state]){
+        for (string &path : state_textures[game_state]){
+            if (world_textures.find(path) == world_textures.end()){
+                world_textures[path] = textures.acquire(path);
+            }
+        }
+        if (game_state == PLAYING){
+            player.loadTextures(textures);
+            health_bar.loadTexture(textures);
+        }
+        bindTextures();
+
+        state_textures_loaded[game_state] = true;
+        textures.prefetch(state_textures[next_state[game_state]]);
+    }
+
+    textures.pump(TEXTURE_PUMP_MAX);
+}
+
+void World::bindTextures(){
+    // point clips and texture variables at whatever has been loaded so far
+    RenderBackend &render = render_backend;
+
+    // missiles
+    missile_clip = animation_clips.add("missile", {texture(missile_path)}, 1);
+
+    // particles
+    particle_clips.clear();
+    for (string &path : particle_paths){
+        SDL_Texture *particle_texture = texture(path);
+        if (particle_texture != NULL){
+            render.setBlendMode(particle_texture, SDL_BLENDMODE_BLEND);
+        }
+        particle_clips.push_back(animation_clips.add("particle_" + to_string(particle_clips.size()), {particle_texture}, 1));
+    }
+
+    // enemies
+    for (string &type : enemy_types){
+        enemy_textures[type].clear();
+        for (string &path : enemy_texture_paths[type]){
+            enemy_textures[type].push_back(texture(path));
+        }
+        enemy_attacks[type].clear();
+        for (string &path : enemy_attack_paths[type]){
+            enemy_attacks[type].push_back(texture(path));
+        }
+    }
+
+    // set blend mode for enemy textures
+    for (auto [type, texture]: enemy_textures){
+        for (SDL_Texture* enemy_texture: texture){
+            if (enemy_texture != NULL){
+                render.setBlendMode(enemy_texture, SDL_BLENDMODE_BLEND);
+            }
+        }
+    }
+
+    // enemy animation clips
+    for (auto& [type, textures]: enemy_textures){
+        enemy_clips[type] = animation_clips.add(type, textures, enemy_data[type]["frame_delay_ticks"]);
+    }
+    for (auto& [type, textures]: enemy_attacks){
+        attack_clips[type] = animation_clips.add(type + "_attack", textures, enemy_data[type]["attack_next_frame_ticks"]);
+    }
+
+    // explosions
+    vector<SDL_Texture*> explosion_texture;
+    for (string &path : explosion_paths){
+        explosion_texture.push_back(texture(path));
+    }
+    hit_explosion_clip = animation_clips.add("hit_explosion", explosion_texture, 5, ANIMATION_ONCE);
+    enemy_explosion_clip = animation_clips.add("enemy_explosion", explosion_texture, 10, ANIMATION_ONCE);
+    player_explosion_clip = animation_clips.add("player_explosion", explosion_texture, 20, ANIMATION_ONCE);
+
+    // fake glow
+    glow_vignette = texture(glow_path);
+    if (glow_vignette != NULL){
+        render.setBlendMode(glow_vignette, SDL_BLENDMODE_BLEND);
+    }
+
+    // scrolling background
+    background_texture = texture(background_path);
+
+    // arrow next to current menu selection
+    selection_arrow_texture = texture(selection_arrow_path);
+
+    // menu dim
+    dim_texture = texture(dim_path);
+    if (dim_texture != NULL){
+        render.setBlendMode(dim_texture, SDL_BLENDMODE_BLEND);
+        render.setAlpha(dim_texture, 125);
+    }
+
+    // death black background
+    death_transition_background = texture(death_transition_path);
+    if (death_transition_background != NULL){
+        render.setBlendMode(death_transition_background, SDL_BLENDMODE_BLEND);
+    }
+}
+
+void World::applyConfig(ConfigSections &config){
+    // [waves] is spawning, every other section is an enemy type
+    for (auto& [section, values]: config){
+        for (auto& [key, value]: values){
+            (section == "waves" ? wave_data : enemy_data[section])[key] = value;
+        }
+    }
+
+    // animation speeds, spawn timing and enemies that are already alive
+    applyAnimationTiming();
+    rand_spawn_ticks = uniform_int_distribution<int>(wave_data["spawn_ticks_min"], max(wave_data["spawn_ticks_min"], wave_data["spawn_ticks_max"]));
+    retuneEnemiesSystem(entities, timers, game_ticks, enemy_data, enemy_types);
+
+    // a world that hasn't started yet starts with the new enemy count
+    if (game_state != PLAYING){
+        max_enemies = wave_data["start_max_enemies"];
+    }
+}
+
+void World::applyAnimationTiming(){
+    // enemy and enemy attack clips play at the speeds in enemy_data (after a config reload or a load)
+    for (auto& [type, textures]: enemy_textures){
+        animation_clips.add(type, textures, enemy_data[type]["frame_delay_ticks"]);
+    }
+    for (auto& [type, textures]: enemy_attacks){
+        animation_clips.add(type + "_attack", textures, enemy_data[type]["attack_next_frame_ticks"]);
+    }
+}
+
+void World::update(WorldInput &input){
+
+    game_ticks += 1;
+
+    if (input.quit){
+        running = false;
+    }
+
+    if (game_state == MENU){
+        updateMenu(input);
+    } else if (game_state == DEATH_SCREEN){
+        updateDeathScreen(input);
+    } else if (game_state == PLAYING){
+        updatePlaying(input);
+    }
+
+    camera.update(rand_generator);
+}
+
+void World::render(){
+    loadStateTextures();
+
+    if (game_state == MENU){
+        renderMenu();
+    } else if (game_state == DEATH_SCREEN){
+        renderDeathScreen();
+    } else if (game_state == PLAYING){
+        renderPlaying();
+    }
+
+    // quality debug readout
+    quality_governor.renderDebug(render_backend, camera, font_renderer, 10, 40);
+}
+
+void World::spawnEnemy(string enemy_type, bool boss, float x, float y){
+    Entity enemy = createEnemy(
+        entities,
+        enemy_data[enemy_type],
+        find(enemy_types.begin(), enemy_types.end(), enemy_type) - enemy_types.begin(),
+        boss,
+        has_particles[enemy_type],
+        animation_clips.start(enemy_clips[enemy_type], game_ticks),
+        attack_clips[enemy_type],
+        x, y,
+        game_ticks
+    );
+
+    // picks its first target this tick
+    timers.schedule(enemy, TIMER_SHOT, entities.get<Shooter>(enemy) -> next_shot_tick);
+    scheduleWanderTimers(timers, enemy, *entities.get<Wander>(enemy));
+}
+
+void World::scrollBackground(){
+    // scrolling backgrounds
+    background_1.y += 4;
+    background_2.y += 4;
+
+    // scrolling system
+    if (background_1.y >= 700){
+        background_1.y = -700;
+    } else if (background_2.y >= 700){
+        background_2.y = -700;
+    }
+}
+
+void World::renderBackground(){
+    // cheap solution to avoiding gaps between two backgrounds by only moving x of the backgrounds.
+    SDL_Rect new_background_1 = {background_1.x, background_1.y - camera.y, background_1.w, background_1.h};
+    SDL_Rect new_background_2 = {background_2.x, background_2.y - camera.y, background_2.w, background_2.h};
+
+    camera.renderCopy(render_backend, background_texture, NULL, &new_background_1);
+    camera.renderCopy(render_backend, background_texture, NULL, &new_background_2);
+}
+
+void World::renderGlows(){
+    glowRenderSystem(entities, bloom, bloom_enabled, glow_locs, quality_governor.level(QUALITY_GLOW), game_ticks);
+
+    if (bloom_enabled){
+        bloom.blur();
+        bloom.render(render_backend, camera);
+        bloom.clear();
+    }
+    for (auto [rect, alpha]: glow_locs){
+        render_backend.setAlpha(glow_vignette, alpha);
+        camera.renderCopy(render_backend, glow_vignette, NULL, &rect);
+    }
+
+    // clear glow locs
+    glow_locs.clear();
+}
+
+void World::updateMenu(WorldInput &input){
+
+    // handle key presses
+    for (SDL_Keycode key: input.pressed){
+        if (key == SDLK_RETURN){
+            if (menu_selected == "play"){
+                // game state
+                game_state = PLAYING;
+
+                // reset menu stuff
+                entities.each<MenuDecoration>([&](Entity entity, MenuDecoration &menu_decoration){
+                    entities.destroy(entity);
+                });
+
+                // start game music
+                audio.playMusicWav("audio/background-music.wav", -1);
+
+            } else if (menu_selected == "options"){
+
+            } else if (menu_selected == "exit"){
+                running = false;
+            }
+
+        } else if (key == SDLK_DOWN){
+            menu_selected = down_selections[menu_selected];
+        } else if (key == SDLK_UP){
+            menu_selected = up_selections[menu_selected];
+        }
+    }
+
+    new_attack_angle += 4;
+    createMenuShot(entities, animation_clips.start(attack_clips["soldier"], game_ticks), -10, -10, 20, 20, sinDegrees(new_attack_angle), cosDegrees(new_attack_angle));
+
+    scrollBackground();
+
+    // attack update
+    glowSystem(entities);
+    moveSystem(entities);
+    boundsSystem(entities);
+
+    // selection size animation
+    for (auto& [selection, data]: menu_selections){
+        if (menu_selected == selection){
+            // increase size
+            if (data["size"] != 60){
+                data["size"] += 1;
+            }
+        } else {
+            if (data["size"] != 50){
+                data["size"] -= 1;
+            }
+        }
+    }
+}
+
+void World::renderMenu(){
+    RenderBackend &render = render_backend;
+
+    // clear render buffer
+    render.clear();
+
+    renderBackground();
+
+    // show glows and enemy attacks
+    renderGlows();
+    renderSystem(entities, render, camera, animation_clips, game_ticks, LAYER_ENEMY_ATTACKS);
+
+    // menu dim
+    render.setAlpha(dim_texture, 125);
+    camera.renderCopy(render, dim_texture, NULL, &dim_rect);
+
+    // show game title
+    font_renderer.renderTextCentered(render, camera, "overwhelming", 300, 250, 60, 230, 230, 230);
+
+    // selections
+    for (auto& [selection, data]: menu_selections){
+
+        // show
+        int text_width = font_renderer.renderTextCentered(render, camera, selection, data["x"], data["y"], data["size"], 230, 230, 230);
+
+        // arrows around if selected
+        if (menu_selected == selection){
+
+            // left arrow
+            selection_arrow_rect.x = data["x"] - selection_arrow_rect.w - text_width / 2 - 10;
+            selection_arrow_rect.y = data["y"] - selection_arrow_rect.h + 9;
+            camera.renderCopy(render, selection_arrow_texture, NULL, &selection_arrow_rect);
+
+            // right arrow
+            selection_arrow_rect.x = data["x"] + text_width / 2 - 3;
+            camera.renderCopyEx(render, selection_arrow_texture, NULL, &selection_arrow_rect, 0, NULL, SDL_FLIP_HORIZONTAL);
+        }
+    }
+}
+
+void World::updateDeathScreen(WorldInput &input){
+    for (SDL_Keycode key: input.pressed){
+        if (key == SDLK_RETURN){
+            // back to menu
+            game_state = MENU;
+        }
+    }
+}
+
+void World::renderDeathScreen(){
+    RenderBackend &render = render_backend;
+
+    // clear render buffer
+    render.clear();
+
+    // death background
+    render.setAlpha(death_transition_background, 255);
+    camera.renderCopy(render, death_transition_background, NULL, &death_transition_rect);
+
+    // death message
+    font_renderer.renderTextCentered(render, camera, "you died", 300, 200, 70, 255, 255, 255);
+    font_renderer.renderTextCentered(render, camera, "press enter to continue", 300, 500, 30, 255, 255, 255);
+}
+
+void World::updatePlaying(WorldInput &input){
+
+    // timers due this tick (handled by the enemy systems below)
+    timers.advance(game_ticks);
+
+    // handle key presses
+    for (SDL_Keycode key: input.pressed){
+        if (key == SDLK_g){
+            spawnEnemy("compass", false, 300, 350);
+        } else if (key == SDLK_h){
+            audio.playChunkWav("audio/next-wave.wav");
+        } else if (key == SDLK_b){
+            bloom_enabled = !bloom_enabled;
+        } else if (key == SDLK_F3){
+            quality_governor.show_debug = !quality_governor.show_debug;
+        }
+    }
+
+    // movement, shooting only available if player is still alive
+    if (player.health > 0){
+
+        // held keys
+        if (input.left){
+            if (player.display_rect.x > 0){
+                player.x -= player.speed;
+            }
+        }
+        if (input.right){
+            if (player.display_rect.x + player.display_rect.w < 600){
+                player.x += player.speed;
+            }
+        }
+        if (input.up){
+            if (player.display_rect.y > 0){
+                player.y -= player.speed;
+            }
+        }
+        if (input.down){
+            if (player.display_rect.y + player.display_rect.h < 700){
+                player.y += player.speed;
+            }
+        }
+
+        // player shooting
+        if (game_ticks % 10 == 0){
+            float pan = (player.display_rect.x + player.display_rect.w / 2) / 300.0f - 1; // a bit towards the player's side
+            audio.playChunkWav("audio/player-shot.wav", 1, pan / 2);
+            createMissile(entities, animation_clips.start(missile_clip, game_ticks), player.display_rect.x, player.display_rect.y, 6, player.damage);
+            createMissile(entities, animation_clips.start(missile_clip, game_ticks), player.display_rect.x + player.display_rect.w, player.display_rect.y, 6, player.damage);
+        }
+
+    }
+
+    // spawn enemies
+    if (game_ticks >= next_spawn_tick){
+
+        next_spawn_tick = game_ticks + rand_spawn_ticks(rand_generator) + 1;
+
+        // spawn if less than max
+        int real_max = (1 + (max_enemies - 1) * (wave % max(int(wave_data["boss_every"]), 1) != 0)); // 1 max for every 5 waves (boss waves)
+        if (entities.count<EnemyInfo>() < real_max && game_ticks >= next_wave_tick && spawned_already != real_max){
+
+            // random enemy
+            string enemy_type = (real_max == 1) ? choose_bosses[rand_boss_index(rand_generator)] : choose_enemies[rand_enemy_index(rand_generator)];
+
+            // random spawn position (cannot go offscreen)
+            uniform_int_distribution<int> rand_x_spawn(0 + enemy_data[enemy_type]["width"] / 2, 600 - enemy_data[enemy_type]["width"] / 2);
+            uniform_int_distribution<int> rand_y_spawn(0 + enemy_data[enemy_type]["height"] / 2, 500 - enemy_data[enemy_type]["height"] / 2); // don't go too close to the bottom
+
+            // add enemy
+            int spawn_x = rand_x_spawn(rand_generator);
+            int spawn_y = rand_y_spawn(rand_generator);
+            spawnEnemy(enemy_type, real_max == 1, spawn_x, spawn_y);
+
+            spawned_already += 1;
+
+        }
+
+        // check if next wave
+        if (spawned_already == real_max && entities.count<EnemyInfo>() == 0){
+            next_wave_tick = game_ticks + wave_data["next_wave_ticks"];
+            max_enemies += wave_data["enemies_per_wave"];
+            spawned_already = 0;
+            wave += 1;
+            wave_start = true;
+
+            // play wave transition sound
+            audio.playChunkWav("audio/next-wave.wav");
+        }
+    }
+
+    // rocket thruster particles
+    for (int i = 0; i != quality_governor.level(QUALITY_PARTICLES) * (player.health > 0); i++){
+        int new_angle = thruster_particle_angle(rand_generator);
+        int new_size = thruster_particle_size(rand_generator);
+        float new_vel_mult = thruster_particle_mult(rand_generator) * .01f;
+        Animation particle_animation = animation_clips.start(particle_clips[thruster_particle_texture(rand_generator)], game_ticks);
+        createParticle(entities, particle_animation, player.x, 10 + player.rect.y + player.rect.h / 2, -sinDegrees(new_angle) * new_vel_mult, -cosDegrees(new_angle) * new_vel_mult, 255, new_size, new_size);
+    }
+
+    scrollBackground();
+
+    // missiles hitting enemies
+    entities.each<Position, Size, PlayerShot>([&](Entity missile, Position &missile_position, Size &missile_size, PlayerShot &player_shot){
+        SDL_Rect missile_rect = entityRect(missile_position, missile_size);
+        bool hit = false;
+
+        // check for collision
+        entities.each<Position, Size, Health>([&](Entity enemy, Position &enemy_position, Size &enemy_size, Health &health){
+            SDL_Rect enemy_rect = entityRect(enemy_position, enemy_size);
+            if (hit || !SDL_HasIntersection(&missile_rect, &enemy_rect)){
+                return;
+            }
+            hit = true;
+
+            // explosion
+            if (quality_governor.spawnExplosion()){
+                createExplosion(entities, animation_clips.start(hit_explosion_clip, game_ticks), missile_position.x, missile_position.y);
+            }
+
+            // remove health
+            health.health -= player_shot.damage;
+
+            // shake camera
+            if (quality_governor.level(QUALITY_SHAKE) == 2){
+                camera.shake(5, 2);
+            }
+        });
+
+        if (hit){
+            entities.destroy(missile);
+        }
+    });
+
+    // enemies
+    shooterSystem(entities, timers);
+    wanderSystem(entities, timers, rand_generator);
+
+    // dead enemies
+    entities.each<Position, Size, Health, EnemyInfo>([&](Entity enemy, Position &position, Size &size, Health &health, EnemyInfo &info){
+        if (health.health > 0){
+            return;
+        }
+
+        // add bigger explosion
+        createExplosion(entities, animation_clips.start(enemy_explosion_clip, game_ticks), position.x, position.y, size.width, size.height);
+
+        // more shake if enemy is boss
+        if (quality_governor.level(QUALITY_SHAKE) && !info.boss){
+            camera.shake(80, 5, true);
+        } else if (quality_governor.level(QUALITY_SHAKE)){
+            camera.shake(270, 8, true);
+        }
+
+        entities.destroy(enemy);
+    });
+
+    // some particles (every 2 ticks at full quality, less often when lagging)
+    int death_trail_level = quality_governor.level(QUALITY_PARTICLES);
+    if (death_trail_level && game_ticks % (2 * (4 - death_trail_level)) == 0){
+        entities.each<Position, Trail>([&](Entity entity, Position &position, Trail &trail){
+            int new_angle = death_particle_angle(rand_generator);
+            int new_size = death_particle_size(rand_generator);
+            float new_vel_mult = death_particle_mult(rand_generator) * .01f;
+            createParticle(entities, animation_clips.start(particle_clips[3], game_ticks), position.x, position.y, sinDegrees(new_angle) * new_vel_mult, cosDegrees(new_angle) * new_vel_mult, 255, new_size, new_size, 0.1f, 2);
+        });
+    }
+
+    // enemy attacks hitting the player (where they are this tick comes from their trajectory)
+    entities.each<Trajectory, Size, EnemyShot>([&](Entity attack, Trajectory &trajectory, Size &size, EnemyShot &enemy_shot){
+        Position position = trajectoryPosition(trajectory, game_ticks);
+        SDL_Rect attack_rect = entityRect(position, size);
+        if (!SDL_HasIntersection(&player.rect, &attack_rect)){
+            return;
+        }
+
+        player.health -= enemy_shot.damage;
+
+        // explode if player still alive
+        if (player.health > 0 && quality_governor.spawnExplosion()){
+            createExplosion(entities, animation_clips.start(hit_explosion_clip, game_ticks), position.x, position.y);
+        }
+
+        entities.destroy(attack);
+    });
+
+    // and the ones that have left the screen
+    trajectoryExitSystem(entities, timers);
+
+    // everything else (glows, movement, fading, leaving the screen, finished explosions)
+    glowSystem(entities);
+    moveSystem(entities);
+    fadeSystem(entities);
+    boundsSystem(entities);
+    expireSystem(entities, animation_clips, game_ticks);
+
+    // wave text position
+    if (wave_start){
+        wave_text_x += max(abs(int((300 - wave_text_x) / 20)), 1);
+        if (wave_text_x >= 700){
+            wave_start = false;
+        }
+    } else {
+        wave_text_x = -300;
+    }
+
+    // check if player dead
+    if (player.health <= 0){
+
+        // player explosion animation (starts again once it has finished)
+        if (!entities.valid(player_death_explosion)){
+            player_death_explosion = createExplosion(entities, animation_clips.start(player_explosion_clip, game_ticks), player.x, player.y, player.display_rect.w * 3, player.display_rect.h * 3);
+        }
+
+        death_transition_alpha += 1;
+
+        // transition finished?
+        if (death_transition_alpha == 255){
+
+            // clear game
+            entities.clear();
+            timers.clear(game_ticks);
+
+            // wave and spawning reset
+            wave = 1;
+            max_enemies = wave_data["start_max_enemies"];
+            next_spawn_tick = 0;
+            spawned_already = 0;
+            next_wave_tick = 0;
+            wave_start = true;
+
+            // clear death stuff
+            death_transition_alpha = 0;
+
+            // reset player
+            player = Player(textures);
+
+            // game state
+            game_state = DEATH_SCREEN;
+
+            // end music
+            audio.fadeOutMusic(300);
+        }
+
+    } else {
+
+        // player update
+        player.update();
+
+    }
+}
+
+void World::renderPlaying(){
+    RenderBackend &render = render_backend;
+
+    // clear render buffer
+    render.clear();
+
+    renderBackground();
+
+    // layers: missiles | particles | glows | enemy attacks | enemies | explosions
+
+    // show missiles and particles
+    renderSystem(entities, render, camera, animation_clips, game_ticks, LAYER_MISSILES);
+    renderSystem(entities, render, camera, animation_clips, game_ticks, LAYER_PARTICLES);
+
+    // show glows
+    renderGlows();
+
+    // show enemy attacks, enemies and explosions
+    renderSystem(entities, render, camera, animation_clips, game_ticks, LAYER_ENEMY_ATTACKS);
+    renderSystem(entities, render, camera, animation_clips, game_ticks, LAYER_ENEMIES);
+    renderSystem(entities, render, camera, animation_clips, game_ticks, LAYER_EXPLOSIONS);
+
+    // healthbar and wave text, into the hud layer when they've changed
+    int shown_health = player.health * (player.health > 0);
+    hud.update(render, camera, shown_health, player.max_health, wave, [&](Camera &hud_camera){
+        health_bar.update(render, hud_camera, player.health, player.max_health);
+        ostringstream healthbar_text;
+        healthbar_text << shown_health << "hp";
+        font_renderer.renderTextCentered(render, hud_camera, healthbar_text.str(), 300, 10, 25, 0, 0, 0);
+
+        ostringstream wave_text;
+        wave_text << "wave " << wave;
+        font_renderer.renderTextCentered(render, hud_camera, wave_text.str(), HUD_WIDTH / 2, HUD_STRIP_HEIGHT + HUD_BANNER_HEIGHT / 2, 90, 255, 255, 255);
+    });
+    hud.renderStrip(render, camera);
+
+    // wave text
+    if (wave_start){
+
+        // background dim
+        render.setAlpha(dim_texture, max(150 - (150 * abs(int(300 - wave_text_x)) / 350), 0));
+        camera.renderCopy(render, dim_texture, NULL, &dim_rect);
+
+        // show text
+        hud.renderBanner(render, camera, wave_text_x, 350);
+    }
+
+    // death transition, or the player
+    if (player.health <= 0){
+        render.setAlpha(death_transition_background, death_transition_alpha);
+        camera.renderCopy(render, death_transition_background, NULL, &death_transition_rect);
+    } else {
+        player.render(render, camera);
+    }
+}